@@ -8,6 +8,8 @@ public class GameQuestGraph : ModuleRules
 	{
 		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
 
+		SetupIrisSupport(Target);
+
 		PublicIncludePaths.AddRange(
 			new string[] {
 				// ... add public include paths required here ...
@@ -26,6 +28,7 @@ public class GameQuestGraph : ModuleRules
 			new string[]
 			{
 				"Core",
+				"NetCore",
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);
@@ -38,7 +41,6 @@ public class GameQuestGraph : ModuleRules
 				"Engine",
 				"Slate",
 				"SlateCore",
-				"NetCore",
 				"UMG",
 				// ... add private dependencies that you statically link with here ...	
 			}
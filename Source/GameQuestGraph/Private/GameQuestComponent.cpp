@@ -3,26 +3,53 @@
 
 #include "GameQuestComponent.h"
 
+#include "GameQuestElementBase.h"
 #include "GameQuestGraphBase.h"
+#include "GameQuestSequenceBase.h"
+#include "GameQuestTickManager.h"
 #include "Engine/ActorChannel.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
 #include "Net/UnrealNetwork.h"
 #include "Net/Core/PushModel/PushModel.h"
+#include "Net/Subsystems/NetworkSubsystem.h"
+
+TAutoConsoleVariable<bool> CVarGameQuestBatchElementRequests
+{
+	TEXT("GameQuest.BatchElementRequests"),
+	true,
+	TEXT("Client element finish and unfinish requests of one frame are sent by one reliable RPC, finish cancelled by unfinish is not sent")
+};
 
 UGameQuestComponent::UGameQuestComponent()
 {
-	PrimaryComponentTick.bCanEverTick = true;
+	// Tickable quest nodes are ticked by UGameQuestTickManager
+	PrimaryComponentTick.bCanEverTick = false;
 	SetIsReplicatedByDefault(true);
+	// Quests and their subobjects are registered when added, ReplicateSubobjects is only used when it is disabled
+	// Iris only replicate subobject by the registered list, keep it enabled when use Iris
+	bReplicateUsingRegisteredSubObjectList = true;
 }
 
-void UGameQuestComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+void UGameQuestComponent::PostInitProperties()
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	Super::PostInitProperties();
 
-	for (int32 Idx = ActivatedQuests.Num() - 1; Idx >= 0 && Idx < ActivatedQuests.Num(); --Idx)
+	ActivatedQuestList.Owner = this;
+	ActivatedQuestList.Summary = &ActivatedQuestSummary;
+	FinishedQuestList.Owner = this;
+	FinishedQuestList.Summary = &FinishedQuestSummary;
+	FinishedQuestList.bFinishedList = true;
+	ArchivedQuests.Owner = this;
+}
+
+void UGameQuestComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UGameQuestTickManager* TickManager = UGameQuestTickManager::Get(this))
 	{
-		UGameQuestGraphBase* Quest = ActivatedQuests[Idx];
-		Quest->Tick(DeltaTime);
+		TickManager->UnregisterComponent(this);
 	}
+	Super::EndPlay(EndPlayReason);
 }
 
 void UGameQuestComponent::Activate(bool bReset)
@@ -57,15 +84,33 @@ void UGameQuestComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>&
 
 	FDoRepLifetimeParams SharedParams;
 	SharedParams.bIsPushBased = true;
+	// Set by replication scope
+	SharedParams.Condition = COND_Dynamic;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ActivatedQuestList, SharedParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, FinishedQuestList, SharedParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ActivatedQuestSummary, SharedParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, FinishedQuestSummary, SharedParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ArchivedQuests, SharedParams);
+}
+
+void UGameQuestComponent::ReadyForReplication()
+{
+	Super::ReadyForReplication();
 
-	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ActivatedQuests, SharedParams);
-	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, FinishedQuests, SharedParams);
+	UpdateReplicationConditions();
 }
 
 bool UGameQuestComponent::ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags)
 {
 	bool WroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
 
+	// Legacy path has no net group, team scope replicate to everyone
+	if (GetQuestNetCondition() == COND_OwnerOnly && RepFlags->bNetOwner == false)
+	{
+		return WroteSomething;
+	}
+
 	for (UGameQuestGraphBase* GameQuest : ActivatedQuests)
 	{
 		if (GameQuest)
@@ -87,46 +132,276 @@ bool UGameQuestComponent::ReplicateSubobjects(UActorChannel* Channel, FOutBunch*
 	return WroteSomething;
 }
 
-void UGameQuestComponent::OnRep_ActivatedQuests()
+ELifetimeCondition UGameQuestComponent::GetQuestNetCondition() const
+{
+	switch (ReplicationScope)
+	{
+	case EGameQuestReplicationScope::OwnerOnly:
+	case EGameQuestReplicationScope::OwnerDetailOthersSummary:
+		return COND_OwnerOnly;
+	case EGameQuestReplicationScope::Team:
+		return COND_NetGroup;
+	default:
+		return COND_None;
+	}
+}
+
+void UGameQuestComponent::UpdateReplicationConditions()
+{
+	// Quest list reference quest object, follow the quest detail scope
+	// Property has no net group condition, team scope list replicate to everyone
+	const ELifetimeCondition NetCondition = GetQuestNetCondition();
+	const ELifetimeCondition ListCondition = NetCondition == COND_NetGroup ? COND_None : NetCondition;
+	DOREPDYNAMICCONDITION_SETCONDITION_FAST(ThisClass, ActivatedQuestList, ListCondition);
+	DOREPDYNAMICCONDITION_SETCONDITION_FAST(ThisClass, FinishedQuestList, ListCondition);
+	// Summary and archive record only have quest class, keep them for everyone unless owner only
+	const ELifetimeCondition SummaryCondition = ReplicationScope == EGameQuestReplicationScope::OwnerOnly ? COND_OwnerOnly : COND_None;
+	DOREPDYNAMICCONDITION_SETCONDITION_FAST(ThisClass, ActivatedQuestSummary, SummaryCondition);
+	DOREPDYNAMICCONDITION_SETCONDITION_FAST(ThisClass, FinishedQuestSummary, SummaryCondition);
+	DOREPDYNAMICCONDITION_SETCONDITION_FAST(ThisClass, ArchivedQuests, SummaryCondition);
+}
+
+void UGameQuestComponent::AddReplicatedQuestSubObject(UObject* SubObject)
+{
+	const ELifetimeCondition NetCondition = GetQuestNetCondition();
+	AddReplicatedSubObject(SubObject, NetCondition);
+	if (NetCondition == COND_NetGroup)
+	{
+		UNetworkSubsystem* NetworkSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UNetworkSubsystem>() : nullptr;
+		if (ensure(NetworkSubsystem))
+		{
+			NetworkSubsystem->GetNetConditionGroupManager().RegisterSubObjectInGroup(SubObject, ReplicationGroup);
+		}
+	}
+}
+
+void UGameQuestComponent::RemoveReplicatedQuestSubObject(UObject* SubObject)
 {
-	TSet<TObjectPtr<UGameQuestGraphBase>> ActivatedQuestsSet{ ActivatedQuests };
-	for (TObjectPtr<UGameQuestGraphBase>& AddGameQuest : ActivatedQuestsSet.Difference(PreActivatedQuests))
+	if (GetQuestNetCondition() == COND_NetGroup)
+	{
+		if (UNetworkSubsystem* NetworkSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UNetworkSubsystem>() : nullptr)
+		{
+			NetworkSubsystem->GetNetConditionGroupManager().UnregisterSubObjectFromGroup(SubObject, ReplicationGroup);
+		}
+	}
+	RemoveReplicatedSubObject(SubObject);
+}
+
+void UGameQuestComponent::SetReplicationScope(EGameQuestReplicationScope Scope, FName Group)
+{
+	if (ReplicationScope == Scope && ReplicationGroup == Group)
+	{
+		return;
+	}
+	// Registered subobjects keep the condition added with, register again by new scope
+	const bool bRegisterSubObjects = IsUsingRegisteredSubObjectList();
+	TArray<UGameQuestGraphBase*> Quests{ ActivatedQuests };
+	Quests.Append(FinishedQuests);
+	if (bRegisterSubObjects)
 	{
-		if (ensure(AddGameQuest))
+		for (UGameQuestGraphBase* Quest : Quests)
 		{
-			AddGameQuest->bIsActivated = true;
-			WhenQuestActivated(AddGameQuest);
+			Quest->UnregisterReplicatedSubObjects(*this);
 		}
 	}
-	for (TObjectPtr<UGameQuestGraphBase> RemovedGameQuest : PreActivatedQuests.Difference(ActivatedQuestsSet))
+	ReplicationScope = Scope;
+	ReplicationGroup = Group;
+	if (bRegisterSubObjects)
 	{
-		if (ensure(RemovedGameQuest))
+		for (UGameQuestGraphBase* Quest : Quests)
 		{
-			RemovedGameQuest->bIsActivated = false;
-			WhenQuestDeactivated(RemovedGameQuest);
+			Quest->RegisterReplicatedSubObjects(*this);
 		}
 	}
-	PreActivatedQuests = ::MoveTemp(ActivatedQuestsSet);
+	UpdateReplicationConditions();
+}
+
+TArray<TSubclassOf<UGameQuestGraphBase>> UGameQuestComponent::GetActivatedQuestSummary() const
+{
+	TArray<TSubclassOf<UGameQuestGraphBase>> QuestClasses;
+	for (const FGameQuestSummaryItem& Item : ActivatedQuestSummary.Items)
+	{
+		QuestClasses.Add(Item.QuestClass);
+	}
+	return QuestClasses;
+}
+
+TArray<TSubclassOf<UGameQuestGraphBase>> UGameQuestComponent::GetFinishedQuestSummary() const
+{
+	TArray<TSubclassOf<UGameQuestGraphBase>> QuestClasses;
+	for (const FGameQuestSummaryItem& Item : FinishedQuestSummary.Items)
+	{
+		QuestClasses.Add(Item.QuestClass);
+	}
+	return QuestClasses;
 }
 
-void UGameQuestComponent::OnRep_FinishedQuests()
+bool UGameQuestComponent::EnqueueElementRequest(UGameQuestGraphBase& Quest, uint16 ElementId, bool bFinish, uint8 EventIndex)
 {
-	TSet<TObjectPtr<UGameQuestGraphBase>> FinishedQuestsSet{ FinishedQuests };
-	for (UGameQuestGraphBase* FinishGameQuest : FinishedQuestsSet.Difference(PreFinishedQuests))
+	if (CVarGameQuestBatchElementRequests.GetValueOnGameThread() == false || EventIndex == FGameQuestElementBase::InvalidFinishEventIndex)
+	{
+		// Caller send immediate RPC instead, send the batched ones before it to keep the request order
+		FlushElementRequests();
+		return false;
+	}
+	UGameQuestTickManager* TickManager = UGameQuestTickManager::Get(this);
+	if (TickManager == nullptr)
+	{
+		return false;
+	}
+	if (PendingElementRequests.Num() == 0)
+	{
+		TickManager->AddPendingElementRequests(*this);
+	}
+	FGameQuestElementRequestBatch* Batch = PendingElementRequests.FindByPredicate([&Quest](const FGameQuestElementRequestBatch& E) { return E.Quest == &Quest; });
+	if (Batch == nullptr)
+	{
+		Batch = &PendingElementRequests.AddDefaulted_GetRef();
+		Batch->Quest = &Quest;
+	}
+	// Server never see the finish, unfinish after it cancel both. Unfinish then finish is kept, finish event may be different
+	if (bFinish == false)
 	{
-		if (ensure(FinishGameQuest))
+		const int32 FinishIdx = Batch->Requests.FindLastByPredicate([ElementId](const FGameQuestElementRequest& E) { return E.ElementId == ElementId; });
+		if (FinishIdx != INDEX_NONE && Batch->Requests[FinishIdx].bFinish)
 		{
-			WhenFinishedQuestAdded(FinishGameQuest);
+			Batch->Requests.RemoveAt(FinishIdx);
+			return true;
 		}
 	}
-	for (UGameQuestGraphBase* RemoveGameQuest : PreFinishedQuests.Difference(FinishedQuestsSet))
+	FGameQuestElementRequest& Request = Batch->Requests.AddDefaulted_GetRef();
+	Request.ElementId = ElementId;
+	Request.EventIndex = EventIndex;
+	Request.bFinish = bFinish;
+	return true;
+}
+
+void UGameQuestComponent::FlushElementRequests()
+{
+	PendingElementRequests.RemoveAll([](const FGameQuestElementRequestBatch& E) { return E.Quest == nullptr || E.Requests.Num() == 0; });
+	if (PendingElementRequests.Num() > 0)
+	{
+		ApplyElementRequestsToServer(PendingElementRequests);
+	}
+	PendingElementRequests.Reset();
+}
+
+void UGameQuestComponent::ApplyElementRequestsToServer_Implementation(const TArray<FGameQuestElementRequestBatch>& Batches)
+{
+	for (const FGameQuestElementRequestBatch& Batch : Batches)
 	{
-		if (ensure(RemoveGameQuest))
+		UGameQuestGraphBase* Quest = Batch.Quest;
+		UGameQuestGraphBase* MainQuest;
+		if (Quest == nullptr || Quest->GetComponent(MainQuest) != this)
 		{
-			WhenFinishedQuestRemoved(RemoveGameQuest);
+			continue;
+		}
+		for (const FGameQuestElementRequest& Request : Batch.Requests)
+		{
+			if (Request.bFinish == false)
+			{
+				Quest->SetElementUnfinishedToServer_Implementation(Request.ElementId);
+				continue;
+			}
+			FName EventName;
+			const FGameQuestElementBase* Element = Quest->FindElementPtr(Request.ElementId);
+			// Request is from client, invalid one is not our bug
+			if (Element == nullptr || Element->GetFinishEventName(Request.EventIndex, EventName) == false)
+			{
+				UE_LOG(LogGameQuest, Warning, TEXT("Invalid element request %s element %d event %d"), *Quest->GetName(), Request.ElementId, Request.EventIndex);
+				continue;
+			}
+			Quest->SetElementFinishedToServer_Implementation(Request.ElementId, EventName);
 		}
 	}
-	PreFinishedQuests = ::MoveTemp(FinishedQuestsSet);
+}
+
+void FGameQuestListItem::PostReplicatedAdd(const FGameQuestList& InArraySerializer)
+{
+	if (Quest && InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->WhenQuestListItemAdded(InArraySerializer, Quest);
+	}
+}
+
+void FGameQuestListItem::PostReplicatedChange(const FGameQuestList& InArraySerializer)
+{
+	PostReplicatedAdd(InArraySerializer);
+}
+
+void FGameQuestListItem::PreReplicatedRemove(const FGameQuestList& InArraySerializer)
+{
+	if (Quest && InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->WhenQuestListItemRemoved(InArraySerializer, Quest);
+	}
+}
+
+void FGameQuestList::AddQuest(UGameQuestGraphBase* Quest)
+{
+	FGameQuestListItem& Item = Items.AddDefaulted_GetRef();
+	Item.Quest = Quest;
+	MarkItemDirty(Item);
+	if (Summary)
+	{
+		FGameQuestSummaryItem& SummaryItem = Summary->Items.AddDefaulted_GetRef();
+		SummaryItem.QuestClass = Quest->GetClass();
+		Summary->MarkItemDirty(SummaryItem);
+	}
+}
+
+void FGameQuestList::RemoveQuest(UGameQuestGraphBase* Quest)
+{
+	const int32 Idx = Items.IndexOfByPredicate([Quest](const FGameQuestListItem& E) { return E.Quest == Quest; });
+	if (Idx != INDEX_NONE)
+	{
+		Items.RemoveAt(Idx);
+		MarkArrayDirty();
+	}
+	if (Summary)
+	{
+		// Quests of same class are same in summary, remove any one of them
+		const int32 SummaryIdx = Summary->Items.IndexOfByPredicate([Quest](const FGameQuestSummaryItem& E) { return E.QuestClass == Quest->GetClass(); });
+		if (SummaryIdx != INDEX_NONE)
+		{
+			Summary->Items.RemoveAt(SummaryIdx);
+			Summary->MarkArrayDirty();
+		}
+	}
+}
+
+void UGameQuestComponent::WhenQuestListItemAdded(const FGameQuestList& List, UGameQuestGraphBase* Quest)
+{
+	if (List.bFinishedList)
+	{
+		if (FinishedQuests.Contains(Quest) == false)
+		{
+			FinishedQuests.Add(Quest);
+			WhenFinishedQuestAdded(Quest);
+		}
+	}
+	else if (ActivatedQuests.Contains(Quest) == false)
+	{
+		ActivatedQuests.Add(Quest);
+		Quest->bIsActivated = true;
+		WhenQuestActivated(Quest);
+	}
+}
+
+void UGameQuestComponent::WhenQuestListItemRemoved(const FGameQuestList& List, UGameQuestGraphBase* Quest)
+{
+	if (List.bFinishedList)
+	{
+		if (FinishedQuests.RemoveSingle(Quest) > 0)
+		{
+			WhenFinishedQuestRemoved(Quest);
+		}
+	}
+	else if (ActivatedQuests.RemoveSingle(Quest) > 0)
+	{
+		Quest->bIsActivated = false;
+		WhenQuestDeactivated(Quest);
+	}
 }
 
 void UGameQuestComponent::PostStartQuest(UGameQuestGraphBase* StartedQuest)
@@ -138,15 +413,91 @@ void UGameQuestComponent::PostStartQuest(UGameQuestGraphBase* StartedQuest)
 void UGameQuestComponent::PostFinishQuest(UGameQuestGraphBase* FinishedQuest)
 {
 	ActivatedQuests.RemoveSingle(FinishedQuest);
-	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ActivatedQuests, this);
+	ActivatedQuestList.RemoveQuest(FinishedQuest);
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ActivatedQuestList, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ActivatedQuestSummary, this);
 	WhenQuestDeactivated(FinishedQuest);
+	if (bArchiveFinishedQuests)
+	{
+		ArchiveQuest(FinishedQuest);
+		WhenQuestFinished(FinishedQuest);
+		return;
+	}
 	FinishedQuests.Add(FinishedQuest);
-	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, FinishedQuests, this);
+	FinishedQuestList.AddQuest(FinishedQuest);
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, FinishedQuestList, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, FinishedQuestSummary, this);
 	WhenFinishedQuestAdded(FinishedQuest);
 
 	WhenQuestFinished(FinishedQuest);
 }
 
+void UGameQuestComponent::ArchiveQuest(UGameQuestGraphBase* FinishedQuest)
+{
+	FGameQuestArchiveRecord& Record = ArchivedQuests.Items.AddDefaulted_GetRef();
+	Record.QuestClass = FinishedQuest->GetClass();
+	Record.Result = FinishedQuest->GetQuestState() == UGameQuestGraphBase::EState::Interrupted ? EGameQuestArchiveResult::Interrupted : EGameQuestArchiveResult::Finished;
+	for (const FName& RerouteTagName : FinishedQuest->GetRerouteTagNames())
+	{
+		const FGameQuestRerouteTag* RerouteTag = FinishedQuest->GetRerouteTag(RerouteTagName);
+		if (RerouteTag && RerouteTag->PreSequenceId != GameQuest::IdNone)
+		{
+			Record.FinishedRerouteTag = RerouteTagName;
+			break;
+		}
+	}
+	Record.FinishedTime = FDateTime::UtcNow();
+	Record.SaveGeneration = SaveGeneration;
+	RemovedQuestSaves.Add({ FinishedQuest->GetFName(), SaveGeneration });
+	if (bArchiveQuestPath)
+	{
+		TArray<uint16> PendingIds = FinishedQuest->GetStartSequencesIds();
+		for (int32 Idx = 0; Idx < PendingIds.Num(); ++Idx)
+		{
+			const uint16 SequenceId = PendingIds[Idx];
+			const FGameQuestSequenceBase* Sequence = FinishedQuest->GetSequencePtr(SequenceId);
+			if (Sequence->GetSequenceState() != FGameQuestSequenceBase::EState::Finished)
+			{
+				continue;
+			}
+			Record.Path.Add(SequenceId);
+			for (const uint16 NextSequenceId : Sequence->GetNextSequences())
+			{
+				if (FinishedQuest->GetSequencePtr(NextSequenceId)->PreSequence == SequenceId)
+				{
+					PendingIds.AddUnique(NextSequenceId);
+				}
+			}
+		}
+	}
+	ArchivedQuests.MarkItemDirty(Record);
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ArchivedQuests, this);
+	UE_LOG(LogGameQuest, Verbose, TEXT("ArchiveQuest %s"), *FinishedQuest->GetName());
+
+	// Quest is not referenced by component any more, garbage collection release it
+	if (IsUsingRegisteredSubObjectList())
+	{
+		FinishedQuest->UnregisterReplicatedSubObjects(*this);
+	}
+	WhenArchivedQuestAdded(Record);
+}
+
+void FGameQuestArchiveRecord::PostReplicatedAdd(const FGameQuestArchiveRecords& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->WhenArchivedQuestAdded(*this);
+	}
+}
+
+void FGameQuestArchiveRecord::PreReplicatedRemove(const FGameQuestArchiveRecords& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->WhenArchivedQuestRemoved(*this);
+	}
+}
+
 void UGameQuestComponent::AddQuest(UGameQuestGraphBase* Quest, bool AutoActivate)
 {
 	if (!ensure(Quest && Quest->GetOuter() == this))
@@ -158,11 +509,18 @@ void UGameQuestComponent::AddQuest(UGameQuestGraphBase* Quest, bool AutoActivate
 		return;
 	}
 	Quest->Owner = this;
+	Quest->FullSaveGeneration = SaveGeneration;
+	if (IsUsingRegisteredSubObjectList())
+	{
+		Quest->RegisterReplicatedSubObjects(*this);
+	}
 	switch (const UGameQuestGraphBase::EState State = Quest->GetQuestState())
 	{
 	case UGameQuestGraphBase::EState::Unactivated:
 		ActivatedQuests.Add(Quest);
-		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ActivatedQuests, this);
+		ActivatedQuestList.AddQuest(Quest);
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ActivatedQuestList, this);
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ActivatedQuestSummary, this);
 		if (AutoActivate)
 		{
 			Quest->DefaultEntry();
@@ -170,7 +528,9 @@ void UGameQuestComponent::AddQuest(UGameQuestGraphBase* Quest, bool AutoActivate
 		break;
 	case UGameQuestGraphBase::EState::Deactivated:
 		ActivatedQuests.Add(Quest);
-		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ActivatedQuests, this);
+		ActivatedQuestList.AddQuest(Quest);
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ActivatedQuestList, this);
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ActivatedQuestSummary, this);
 		if (AutoActivate)
 		{
 			Quest->ReactiveQuest();
@@ -178,7 +538,9 @@ void UGameQuestComponent::AddQuest(UGameQuestGraphBase* Quest, bool AutoActivate
 		break;
 	case UGameQuestGraphBase::EState::Finished:
 		FinishedQuests.Add(Quest);
-		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, FinishedQuests, this);
+		FinishedQuestList.AddQuest(Quest);
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, FinishedQuestList, this);
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, FinishedQuestSummary, this);
 		WhenFinishedQuestAdded(Quest);
 		break;
 	default: ;
@@ -195,13 +557,24 @@ void UGameQuestComponent::RemoveQuest(UGameQuestGraphBase* Quest)
 	if (Idx != INDEX_NONE)
 	{
 		ActivatedQuests.RemoveAt(Idx);
+		ActivatedQuestList.RemoveQuest(Quest);
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ActivatedQuestList, this);
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ActivatedQuestSummary, this);
 		Quest->DeactivateQuest();
 	}
 	else
 	{
 		Idx = FinishedQuests.IndexOfByKey(Quest);
 		FinishedQuests.RemoveAt(Idx);
+		FinishedQuestList.RemoveQuest(Quest);
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, FinishedQuestList, this);
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, FinishedQuestSummary, this);
 		WhenFinishedQuestRemoved(Quest);
 	}
+	if (IsUsingRegisteredSubObjectList())
+	{
+		Quest->UnregisterReplicatedSubObjects(*this);
+	}
+	RemovedQuestSaves.Add({ Quest->GetFName(), SaveGeneration });
 	Quest->Owner = nullptr;
 }
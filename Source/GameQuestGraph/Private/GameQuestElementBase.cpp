@@ -3,8 +3,10 @@
 
 #include "GameQuestElementBase.h"
 
+#include "GameQuestComponent.h"
 #include "GameQuestGraphBase.h"
 #include "GameQuestSequenceBase.h"
+#include "GameQuestTickManager.h"
 #include "Engine/ActorChannel.h"
 #include "Engine/BlueprintGeneratedClass.h"
 #include "Engine/Console.h"
@@ -13,6 +15,9 @@
 #include "Engine/NetDriver.h"
 #include "Engine/World.h"
 #include "HAL/IConsoleManager.h"
+#if UE_WITH_IRIS
+#include "Iris/ReplicationSystem/ReplicationFragmentUtil.h"
+#endif
 
 
 bool FGameQuestElementBase::IsInterrupted() const
@@ -27,8 +32,7 @@ bool FGameQuestElementBase::IsInterrupted() const
 	{
 		return false;
 	}
-	const uint16 ElementId = OwnerQuest->GetElementId(this);
-	const FGameQuestSequenceBranchElement* Branch = SequenceBranch->Branches.FindByPredicate([&](const FGameQuestSequenceBranchElement& E){ return E.Element == ElementId; });
+	const FGameQuestSequenceBranchElement* Branch = SequenceBranch->FindBranch(OwnerQuest->GetElementId(this));
 	if (Branch == nullptr)
 	{
 		return false;
@@ -36,14 +40,16 @@ bool FGameQuestElementBase::IsInterrupted() const
 	return Branch->bInterrupted;
 }
 
-void FGameQuestElementBase::WhenQuestInitProperties(const FStructProperty* Property)
+void FGameQuestElementBase::BuildQuestInitDesc(FGameQuestNodeInitDesc& Desc, const UClass* QuestClass) const
 {
-	const UClass* QuestClass = OwnerQuest->GetClass();
-	for (TFieldIterator<FStructProperty> It{ Property->Struct }; It; ++It)
+	Super::BuildQuestInitDesc(Desc, QuestClass);
+	for (TFieldIterator<FStructProperty> It{ Desc.Property->Struct }; It; ++It)
 	{
 		if (It->Struct->IsChildOf(FGameQuestFinishEvent::StaticStruct()))
 		{
-			It->ContainerPtrToValuePtr<FGameQuestFinishEvent>(this)->Event = QuestClass->FindFunctionByName(FGameQuestFinishEvent::MakeEventName(Property->GetFName(), It->GetFName()));
+			const FGameQuestFinishEvent* FinishEvent = It->ContainerPtrToValuePtr<FGameQuestFinishEvent>(this);
+			UFunction* Event = QuestClass->FindFunctionByName(FGameQuestFinishEvent::MakeEventName(Desc.Property->GetFName(), It->GetFName()));
+			Desc.EventBindings.Add(FGameQuestNodeInitDesc::MakeEventBinding(this, FinishEvent->Event, Event));
 		}
 	}
 }
@@ -105,7 +111,7 @@ void FGameQuestElementBase::ActivateElement(bool bIsServer)
 	}
 	if (bIsServer && ShouldReplicatedSubobject())
 	{
-		OwnerQuest->ReplicateSubobjectNodes.AddUnique(this);
+		OwnerQuest->AddReplicateSubobjectNode(this);
 	}
 
 	bIsActivated = true;
@@ -114,7 +120,10 @@ void FGameQuestElementBase::ActivateElement(bool bIsServer)
 		UE_LOG(LogGameQuest, Verbose, TEXT("ActivateElement %s.%s"), *OwnerQuest->GetName(), *GetNodeName().ToString());
 		if (IsTickable())
 		{
-			OwnerQuest->TickableElements.Add(this);
+			if (UGameQuestTickManager* TickManager = UGameQuestTickManager::Get(OwnerQuest))
+			{
+				TickManager->RegisterElement(*this);
+			}
 		}
 		WhenElementActivated();
 	}
@@ -135,9 +144,12 @@ void FGameQuestElementBase::DeactivateElement(bool bHasAuthority)
 	if (ShouldEnableJudgment(bHasAuthority))
 	{
 		UE_LOG(LogGameQuest, Verbose, TEXT("DeactivateElement %s.%s"), *OwnerQuest->GetName(), *GetNodeName().ToString());
-		if (IsTickable())
+		if (TickIndex != INDEX_NONE)
 		{
-			OwnerQuest->TickableElements.Remove(this);
+			if (UGameQuestTickManager* TickManager = UGameQuestTickManager::Get(OwnerQuest))
+			{
+				TickManager->UnregisterElement(*this);
+			}
 		}
 		WhenElementDeactivated();
 	}
@@ -179,6 +191,7 @@ void FGameQuestElementBase::FinishElement(const FGameQuestFinishEvent& OnElement
 		return;
 	}
 	bIsFinished = true;
+	OwnerQuest->SetElementFinishedBit(GetNodeId(), true);
 	MarkNodeNetDirty();
 	WhenFinished();
 
@@ -187,7 +200,14 @@ void FGameQuestElementBase::FinishElement(const FGameQuestFinishEvent& OnElement
 		UE_LOG(LogGameQuest, Verbose, TEXT("Finish %s.%s.%s"), *OwnerQuest->GetName(), *GetNodeName().ToString(), *EventName.ToString());
 		if (bIsOptional == false)
 		{
-			OwnerSequence->WhenElementFinished(this, OnElementFinishedEvent);
+			if (UGameQuestTickManager* EventQueue = UGameQuestTickManager::GetDeferredEventQueue(OwnerQuest))
+			{
+				EventQueue->EnqueueFinishElement(*this, OnElementFinishedEvent);
+			}
+			else
+			{
+				OwnerSequence->WhenElementFinished(this, OnElementFinishedEvent);
+			}
 		}
 	}
 	else
@@ -195,7 +215,16 @@ void FGameQuestElementBase::FinishElement(const FGameQuestFinishEvent& OnElement
 		ensure(GetNodeStruct()->FindPropertyByName(EventName));
 
 		UE_LOG(LogGameQuest, Verbose, TEXT("Client Send Finish %s.%s.%s"), *OwnerQuest->GetName(), *GetNodeName().ToString(), *EventName.ToString());
-		OwnerQuest->SetElementFinishedToServer(OwnerQuest->GetElementId(this), EventName);
+		UGameQuestGraphBase* MainQuest;
+		UGameQuestComponent* Component = OwnerQuest->GetComponent(MainQuest);
+		if (Component == nullptr || Component->EnqueueElementRequest(*OwnerQuest, OwnerQuest->GetElementId(this), true, GetFinishEventIndex(EventName)) == false)
+		{
+			OwnerQuest->SetElementFinishedToServer(OwnerQuest->GetElementId(this), EventName);
+		}
+		if (Component && Component->bPredictLocalJudgment && IsLocalJudgment())
+		{
+			OwnerQuest->PredictElementFinished(*this, EventName);
+		}
 	}
 }
 
@@ -211,6 +240,7 @@ void FGameQuestElementBase::UnfinishedElement()
 		return;
 	}
 	bIsFinished = false;
+	OwnerQuest->SetElementFinishedBit(GetNodeId(), false);
 	MarkNodeNetDirty();
 	WhenUnfinished();
 
@@ -219,14 +249,26 @@ void FGameQuestElementBase::UnfinishedElement()
 		UE_LOG(LogGameQuest, Verbose, TEXT("Cancel Finish %s.%s"), *OwnerQuest->GetName(), *GetNodeName().ToString());
 		if (bIsOptional == false)
 		{
-			OwnerSequence->WhenElementUnfinished(this);
+			if (UGameQuestTickManager* EventQueue = UGameQuestTickManager::GetDeferredEventQueue(OwnerQuest))
+			{
+				EventQueue->EnqueueUnfinishElement(*this);
+			}
+			else
+			{
+				OwnerSequence->WhenElementUnfinished(this);
+			}
 		}
 	}
 	else
 	{
 		bIsFinished = false;
 		UE_LOG(LogGameQuest, Verbose, TEXT("Client Send Cancel Finished %s.%s"), *OwnerQuest->GetName(), *GetNodeName().ToString());
-		OwnerQuest->SetElementUnfinishedToServer(OwnerQuest->GetElementId(this));
+		UGameQuestGraphBase* MainQuest;
+		UGameQuestComponent* Component = OwnerQuest->GetComponent(MainQuest);
+		if (Component == nullptr || Component->EnqueueElementRequest(*OwnerQuest, OwnerQuest->GetElementId(this), false, NoneFinishEventIndex) == false)
+		{
+			OwnerQuest->SetElementUnfinishedToServer(OwnerQuest->GetElementId(this));
+		}
 	}
 }
 
@@ -248,6 +290,52 @@ void FGameQuestElementBase::FinishElementByName(const FName& EventName)
 	}
 }
 
+uint8 FGameQuestElementBase::GetFinishEventIndex(const FName& EventName) const
+{
+	if (EventName == NAME_None)
+	{
+		return NoneFinishEventIndex;
+	}
+	uint8 EventIndex = 0;
+	for (TFieldIterator<FStructProperty> It{ GetNodeStruct() }; It && EventIndex < NoneFinishEventIndex; ++It)
+	{
+		if (It->Struct != FGameQuestFinishEvent::StaticStruct())
+		{
+			continue;
+		}
+		if (It->GetFName() == EventName)
+		{
+			return EventIndex;
+		}
+		EventIndex += 1;
+	}
+	return InvalidFinishEventIndex;
+}
+
+bool FGameQuestElementBase::GetFinishEventName(uint8 EventIndex, FName& EventName) const
+{
+	if (EventIndex == NoneFinishEventIndex)
+	{
+		EventName = NAME_None;
+		return true;
+	}
+	uint8 Index = 0;
+	for (TFieldIterator<FStructProperty> It{ GetNodeStruct() }; It && Index < NoneFinishEventIndex; ++It)
+	{
+		if (It->Struct != FGameQuestFinishEvent::StaticStruct())
+		{
+			continue;
+		}
+		if (Index == EventIndex)
+		{
+			EventName = It->GetFName();
+			return true;
+		}
+		Index += 1;
+	}
+	return false;
+}
+
 void FGameQuestElementBase::ForceFinishElement(const FName& EventName)
 {
 	WhenForceFinishElement(EventName);
@@ -421,6 +509,9 @@ UGameQuestElementScriptable::UGameQuestElementScriptable(const FObjectInitialize
 	, SupportType(UGameQuestGraphBase::StaticClass())
 #endif
 	, bTickable(false)
+	, TickInterval(0.f)
+	, TickPhase(-1.f)
+	, bIgnoreTickSignificance(false)
 	, bLocalJudgment(false)
 {
 
@@ -444,6 +535,13 @@ void UGameQuestElementScriptable::GetLifetimeReplicatedProps(TArray<FLifetimePro
 	}
 }
 
+#if UE_WITH_IRIS
+void UGameQuestElementScriptable::RegisterReplicationFragments(UE::Net::FFragmentRegistrationContext& Context, UE::Net::EFragmentRegistrationFlags RegistrationFlags)
+{
+	UE::Net::FReplicationFragmentUtil::CreateAndRegisterFragmentsForObject(this, Context, RegistrationFlags);
+}
+#endif
+
 int32 UGameQuestElementScriptable::GetFunctionCallspace(UFunction* Function, FFrame* Stack)
 {
 	if (HasAnyFlags(RF_ClassDefaultObject))
@@ -503,23 +601,55 @@ void UGameQuestElementScriptable::WhenForceFinishElement_Implementation(const FN
 	Owner->FinishElementByName(EventName);
 }
 
-void FGameQuestElementScript::WhenQuestInitProperties(const FStructProperty* Property)
+namespace GameQuestElementScript
 {
-	if (Instance)
+	void BuildInstanceEventBindings(const UGameQuestElementScriptable* ScriptInstance, const FStructProperty* Property, const UClass* QuestClass, TArray<FGameQuestNodeInitDesc::FEventBinding, TInlineAllocator<2>>& OutBindings)
 	{
-		Instance->Owner = this;
-
-		const UClass* QuestClass = OwnerQuest->GetClass();
-		for (TFieldIterator<FStructProperty> It{ Instance->GetClass() }; It; ++It)
+		for (TFieldIterator<FStructProperty> It{ ScriptInstance->GetClass() }; It; ++It)
 		{
 			if (It->Struct->IsChildOf(FGameQuestFinishEvent::StaticStruct()))
 			{
-				It->ContainerPtrToValuePtr<FGameQuestFinishEvent>(Instance)->Event = QuestClass->FindFunctionByName(FGameQuestFinishEvent::MakeEventName(Property->GetFName(), It->GetFName()));
+				const FGameQuestFinishEvent* FinishEvent = It->ContainerPtrToValuePtr<FGameQuestFinishEvent>(ScriptInstance);
+				UFunction* Event = QuestClass->FindFunctionByName(FGameQuestFinishEvent::MakeEventName(Property->GetFName(), It->GetFName()));
+				OutBindings.Add(FGameQuestNodeInitDesc::MakeEventBinding(ScriptInstance, FinishEvent->Event, Event));
 			}
 		}
 	}
 }
 
+void FGameQuestElementScript::BuildQuestInitDesc(FGameQuestNodeInitDesc& Desc, const UClass* QuestClass) const
+{
+	Super::BuildQuestInitDesc(Desc, QuestClass);
+	// Instance of default object decide the instance class, descriptor is not changed after built
+	if (Instance)
+	{
+		Desc.InstanceClass = Instance->GetClass();
+		GameQuestElementScript::BuildInstanceEventBindings(Instance, Desc.Property, QuestClass, Desc.InstanceEventBindings);
+	}
+}
+
+void FGameQuestElementScript::WhenQuestInitProperties(const FGameQuestNodeInitDesc& Desc)
+{
+	Super::WhenQuestInitProperties(Desc);
+	if (Instance)
+	{
+		Instance->Owner = this;
+
+		UGameQuestElementScriptable* ScriptInstance = Instance;
+		if (Desc.InstanceClass == ScriptInstance->GetClass())
+		{
+			FGameQuestNodeInitDesc::ApplyEventBindings(ScriptInstance, Desc.InstanceEventBindings);
+		}
+		else
+		{
+			// Instance class replaced from default, resolve for this instance only
+			TArray<FGameQuestNodeInitDesc::FEventBinding, TInlineAllocator<2>> InstanceEventBindings;
+			GameQuestElementScript::BuildInstanceEventBindings(ScriptInstance, Desc.Property, OwnerQuest->GetClass(), InstanceEventBindings);
+			FGameQuestNodeInitDesc::ApplyEventBindings(ScriptInstance, InstanceEventBindings);
+		}
+	}
+}
+
 AActor* UGameQuestElementScriptable::GetOwnerActor() const
 {
 	return Owner->OwnerQuest->GetOwnerActor();
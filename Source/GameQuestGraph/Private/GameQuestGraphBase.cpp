@@ -8,6 +8,7 @@
 #include "GameQuestGraphBlueprint.h"
 #include "GameQuestNodeBase.h"
 #include "GameQuestSequenceBase.h"
+#include "GameQuestTickManager.h"
 #include "Engine/Engine.h"
 #include "Engine/NetDriver.h"
 #include "GameFramework/Actor.h"
@@ -15,6 +16,14 @@
 #include "HAL/IConsoleManager.h"
 #include "Net/UnrealNetwork.h"
 #include "Net/Core/PushModel/PushModel.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+#include "TimerManager.h"
+#include "UObject/CoreNet.h"
+#include "UObject/StructOnScope.h"
+#if UE_WITH_IRIS
+#include "Iris/ReplicationSystem/ReplicationFragmentUtil.h"
+#endif
 
 TAutoConsoleVariable<bool> CVarGameQuestEnableCheat
 {
@@ -27,6 +36,20 @@ TAutoConsoleVariable<bool> CVarGameQuestEnableCheat
 	TEXT("Enable cheat, e.g. console command finish quest element")
 };
 
+TAutoConsoleVariable<float> CVarGameQuestPredictionTimeout
+{
+	TEXT("GameQuest.PredictionTimeout"),
+	2.f,
+	TEXT("Seconds client wait server process the predicted element finish, rollback to replicated state after it")
+};
+
+TAutoConsoleVariable<bool> CVarGameQuestCompactReplication
+{
+	TEXT("GameQuest.CompactReplication"),
+	false,
+	TEXT("Replicate quest runtime state as one bit packed delta block instead of node properties, read when replication layout created, must be same on server and client, not used with Iris")
+};
+
 void UGameQuestGraphBase::PostInitProperties()
 {
 	Super::PostInitProperties();
@@ -38,18 +61,70 @@ void UGameQuestGraphBase::PostInitProperties()
 			Class->PostQuestCDOInitProperties();
 		}
 	}
+	auto InitNode = [this](const FGameQuestNodeInitDesc& Desc)
+	{
+		FGameQuestNodeBase* QuestNode = reinterpret_cast<FGameQuestNodeBase*>(reinterpret_cast<uint8*>(this) + Desc.Offset);
+		QuestNode->NodeProperty = Desc.Property;
+		QuestNode->OwnerQuest = this;
+		QuestNode->NodeId = Desc.NodeId;
+		QuestNode->LogicList = Desc.LogicList;
+		QuestNode->EvaluateParamsFunction = Desc.EvaluateParamsFunction;
+		FGameQuestNodeInitDesc::ApplyEventBindings(QuestNode, Desc.EventBindings);
+		QuestNode->WhenQuestInitProperties(Desc);
+	};
+	CompactState.Owner = this;
 	UClass* Class = GetClass();
-	for (TFieldIterator<FStructProperty> It{ Class }; It; ++It)
+	if (UGameQuestGraphGeneratedClass* QuestClass = Cast<UGameQuestGraphGeneratedClass>(Class))
 	{
-		if (It->Struct->IsChildOf(FGameQuestNodeBase::StaticStruct()) == false)
+		ActivatedSequenceBits.Init(false, QuestClass->NodeTable.Num());
+		ActivatedBranchBits.Init(false, QuestClass->NodeTable.Num());
+		for (const FGameQuestNodeInitDesc& Desc : QuestClass->NodeInitDescs)
 		{
-			continue;
+			InitNode(Desc);
 		}
-		FGameQuestNodeBase* QuestNode = It->ContainerPtrToValuePtr<FGameQuestNodeBase>(this);
-		QuestNode->NodeProperty = *It;
-		QuestNode->OwnerQuest = this;
-		QuestNode->EvaluateParamsFunction = Class->FindFunctionByName(FGameQuestNodeBase::MakeEvaluateParamsFunctionName(It->GetFName()));
-		QuestNode->WhenQuestInitProperties(*It);
+		// Default values of default object may not be loaded yet, it build the tables in PostLoad
+		if (HasAnyFlags(RF_ClassDefaultObject) == false)
+		{
+			QuestClass->ConditionalBuildRuntimeTables(*this);
+		}
+	}
+	else
+	{
+		for (TFieldIterator<FStructProperty> It{ Class }; It; ++It)
+		{
+			if (It->Struct->IsChildOf(FGameQuestNodeBase::StaticStruct()) == false)
+			{
+				continue;
+			}
+			InitNode(FGameQuestNodeInitDesc{ Class, *It, *It->ContainerPtrToValuePtr<FGameQuestNodeBase>(this) });
+		}
+	}
+}
+
+void UGameQuestGraphBase::PostLoad()
+{
+	Super::PostLoad();
+
+	// Default values and instanced subobjects of default object are loaded now, rebuild class data from them
+	if (HasAnyFlags(RF_ClassDefaultObject))
+	{
+		if (UGameQuestGraphGeneratedClass* Class = Cast<UGameQuestGraphGeneratedClass>(GetClass()))
+		{
+			Class->PostQuestCDOInitProperties();
+			Class->ConditionalBuildRuntimeTables(*this);
+		}
+	}
+}
+
+void UGameQuestGraphBase::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	if (Ar.IsLoading())
+	{
+		RebuildActivatedBits();
+		bListFinishedMasksDirty = true;
+		RefreshSequenceStates();
 	}
 }
 
@@ -76,11 +151,87 @@ void UGameQuestGraphBase::GetLifetimeReplicatedProps(TArray<class FLifetimePrope
 	FDoRepLifetimeParams SharedParams;
 	SharedParams.bIsPushBased = true;
 
-	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, bInterrupted, SharedParams);
+	const UGameQuestGraphGeneratedClass* QuestClass = Cast<UGameQuestGraphGeneratedClass>(GetClass());
+	const bool bCompactReplication = QuestClass && CVarGameQuestCompactReplication.GetValueOnAnyThread() && IsUsingIrisReplication() == false;
+	FDoRepLifetimeParams StateParams = SharedParams;
+	FDoRepLifetimeParams CompactStateParams;
+	if (bCompactReplication)
+	{
+		StateParams.Condition = COND_Never;
+	}
+	else
+	{
+		CompactStateParams.Condition = COND_Never;
+	}
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, bInterrupted, StateParams);
 	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, Owner, SharedParams);
-	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, StartSequences, SharedParams);
-	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ActivatedSequences, SharedParams);
-	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ActivatedBranches, SharedParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, StartSequences, StateParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ActivatedSequences, StateParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ActivatedBranches, StateParams);
+	// Compare by state key, not push based so lost packet resend from the acked base. COND_Never keep it out of Iris descriptor
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, CompactState, CompactStateParams);
+
+	if (bCompactReplication)
+	{
+		// Node which all replicated value covered by compact state no longer replicate itself, its WhenOnRepValue is called by ApplyCompactState
+		for (const FGameQuestNodeInitDesc& Desc : QuestClass->NodeInitDescs)
+		{
+			if (IsCoveredByCompactState(Desc.Property->Struct) == false)
+			{
+				continue;
+			}
+			for (FLifetimeProperty& LifetimeProperty : OutLifetimeProps)
+			{
+				if (LifetimeProperty.RepIndex == Desc.Property->RepIndex)
+				{
+					LifetimeProperty.Condition = COND_Never;
+					break;
+				}
+			}
+		}
+	}
+}
+
+#if UE_WITH_IRIS
+void UGameQuestGraphBase::RegisterReplicationFragments(UE::Net::FFragmentRegistrationContext& Context, UE::Net::EFragmentRegistrationFlags RegistrationFlags)
+{
+	// Fragments are created from the lifetime property list, include blueprint node struct properties and their rep notify
+	UE::Net::FReplicationFragmentUtil::CreateAndRegisterFragmentsForObject(this, Context, RegistrationFlags);
+}
+#endif
+
+bool UGameQuestGraphBase::IsUsingIrisReplication()
+{
+#if UE_WITH_IRIS
+	// Compact state is a legacy net delta serializer which has no Iris net serializer, fall back to node properties
+	static const IConsoleVariable* UseIrisReplication = IConsoleManager::Get().FindConsoleVariable(TEXT("net.Iris.UseIrisReplication"));
+	return UseIrisReplication && UseIrisReplication->GetInt() != 0;
+#else
+	return false;
+#endif
+}
+
+bool UGameQuestGraphBase::IsCoveredByCompactState(const UScriptStruct* NodeStruct)
+{
+	static const TSet<const FProperty*> CoveredProperties
+	{
+		FindFProperty<FProperty>(FGameQuestSequenceBase::StaticStruct(), GET_MEMBER_NAME_CHECKED(FGameQuestSequenceBase, PreSequence)),
+		FindFProperty<FProperty>(FGameQuestSequenceBase::StaticStruct(), TEXT("bInterrupted")),
+		FindFProperty<FProperty>(FGameQuestSequenceSingle::StaticStruct(), GET_MEMBER_NAME_CHECKED(FGameQuestSequenceSingle, NextSequences)),
+		FindFProperty<FProperty>(FGameQuestSequenceList::StaticStruct(), GET_MEMBER_NAME_CHECKED(FGameQuestSequenceList, NextSequences)),
+		// Only next sequences of branch element is replicated
+		FindFProperty<FProperty>(FGameQuestSequenceBranch::StaticStruct(), GET_MEMBER_NAME_CHECKED(FGameQuestSequenceBranch, Branches)),
+		FindFProperty<FProperty>(FGameQuestElementBase::StaticStruct(), TEXT("bIsFinished")),
+	};
+	for (TFieldIterator<FProperty> It{ NodeStruct }; It; ++It)
+	{
+		if (It->HasAnyPropertyFlags(CPF_RepSkip) == false && CoveredProperties.Contains(*It) == false)
+		{
+			return false;
+		}
+	}
+	return true;
 }
 
 int32 UGameQuestGraphBase::GetFunctionCallspace(UFunction* Function, FFrame* Stack)
@@ -126,74 +277,825 @@ bool UGameQuestGraphBase::ReplicateSubobject(UActorChannel* Channel, FOutBunch*
 	return WroteSomething;
 }
 
-void UGameQuestGraphBase::OnRep_ActivatedSequences()
+void UGameQuestGraphBase::AddReplicateSubobjectNode(FGameQuestNodeBase* Node)
 {
-	TSet<uint16> ActivatedSequencesSet{ ActivatedSequences };
-	TSet<uint16> DeactivatedSequences{ PreActivatedSequences.Difference(ActivatedSequencesSet) };
-	TSet<uint16> CurActivatedSequences{ ActivatedSequencesSet.Difference(PreActivatedSequences) };
+	if (ReplicateSubobjectNodes.Contains(Node))
+	{
+		return;
+	}
+	ReplicateSubobjectNodes.Add(Node);
+	if (UObject* SubObject = Node->GetReplicatedSubobject())
+	{
+		RegisterReplicatedSubObject(SubObject);
+	}
+}
 
-	for (const uint16 SequenceId : DeactivatedSequences)
+void UGameQuestGraphBase::RegisterReplicatedSubObject(UObject* SubObject)
+{
+	UGameQuestGraphBase* MainQuest;
+	UGameQuestComponent* Component = GetComponent(MainQuest);
+	if (Component == nullptr || Component->IsUsingRegisteredSubObjectList() == false)
 	{
-		FGameQuestSequenceBase* Sequence = GetSequencePtr(SequenceId);
-		Sequence->OnRepDeactivateSequence(SequenceId);
+		return;
 	}
-	for (const uint16 SequenceId : CurActivatedSequences)
+	if (UGameQuestGraphBase* SubQuest = Cast<UGameQuestGraphBase>(SubObject))
 	{
-		FGameQuestSequenceBase* Sequence = GetSequencePtr(SequenceId);
-		Sequence->OnRepActivateSequence(SequenceId);
+		SubQuest->RegisterReplicatedSubObjects(*Component);
 	}
+	else
+	{
+		Component->AddReplicatedQuestSubObject(SubObject);
+	}
+}
 
-	PreActivatedSequences = ::MoveTemp(ActivatedSequencesSet);
+void UGameQuestGraphBase::RegisterReplicatedSubObjects(UGameQuestComponent& Component)
+{
+	Component.AddReplicatedQuestSubObject(this);
+	for (const FGameQuestNodeBase* ReplicateSubobjectNode : ReplicateSubobjectNodes)
+	{
+		UObject* SubObject = ReplicateSubobjectNode->GetReplicatedSubobject();
+		if (UGameQuestGraphBase* SubQuest = Cast<UGameQuestGraphBase>(SubObject))
+		{
+			SubQuest->RegisterReplicatedSubObjects(Component);
+		}
+		else if (SubObject)
+		{
+			Component.AddReplicatedQuestSubObject(SubObject);
+		}
+	}
 }
 
-void UGameQuestGraphBase::OnRep_ActivatedBranches()
+void UGameQuestGraphBase::UnregisterReplicatedSubObjects(UGameQuestComponent& Component)
 {
-	TSet<uint16> ActivatedBranchesSet{ ActivatedBranches };
-	TSet<uint16> DeactivatedBranches{ PreActivatedBranches.Difference(ActivatedBranchesSet) };
-	TSet<uint16> CurActivatedBranches{ ActivatedBranchesSet.Difference(PreActivatedBranches) };
+	for (const FGameQuestNodeBase* ReplicateSubobjectNode : ReplicateSubobjectNodes)
+	{
+		UObject* SubObject = ReplicateSubobjectNode->GetReplicatedSubobject();
+		if (UGameQuestGraphBase* SubQuest = Cast<UGameQuestGraphBase>(SubObject))
+		{
+			SubQuest->UnregisterReplicatedSubObjects(Component);
+		}
+		else if (SubObject)
+		{
+			Component.RemoveReplicatedQuestSubObject(SubObject);
+		}
+	}
+	Component.RemoveReplicatedQuestSubObject(this);
+}
 
-	for (const uint16 SequenceId : DeactivatedBranches)
+void UGameQuestGraphBase::SetActivatedBit(TBitArray<>& Bits, uint16 Id, bool bValue)
+{
+	if (Bits.Num() <= Id)
 	{
-		FGameQuestSequenceBranch* SequenceBranch = GameQuestCastChecked<FGameQuestSequenceBranch>(GetSequencePtr(SequenceId));
-		if (SequenceBranch->bIsBranchesActivated)
+		Bits.SetNum(Id + 1, false);
+	}
+	Bits[Id] = bValue;
+}
+
+void UGameQuestGraphBase::RebuildActivatedBits()
+{
+	ActivatedSequenceBits.SetRange(0, ActivatedSequenceBits.Num(), false);
+	for (const uint16 SequenceId : ActivatedSequences)
+	{
+		SetActivatedBit(ActivatedSequenceBits, SequenceId, true);
+	}
+	ActivatedBranchBits.SetRange(0, ActivatedBranchBits.Num(), false);
+	for (const uint16 SequenceId : ActivatedBranches)
+	{
+		SetActivatedBit(ActivatedBranchBits, SequenceId, true);
+	}
+}
+
+TBitArray<> UGameQuestGraphBase::UpdateActivatedBits(TBitArray<>& Bits, const TArray<uint16>& Ids)
+{
+	// Inline storage of bit array keep it allocation free for common quest size
+	TBitArray<> ChangedBits{ Bits };
+	Bits.SetRange(0, Bits.Num(), false);
+	for (const uint16 Id : Ids)
+	{
+		SetActivatedBit(Bits, Id, true);
+	}
+	ChangedBits.CombineWithBitwiseXOR(Bits, EBitwiseOperatorFlags::MaxSize);
+	return ChangedBits;
+}
+
+namespace GameQuestCompactState
+{
+	class FBaseState : public INetDeltaBaseState
+	{
+	public:
+		FBaseState(uint32 InStateKey, const TSharedPtr<const FGameQuestCompactStateData>& InData)
+			: StateKey(InStateKey)
+			, Data(InData)
+		{}
+
+		bool IsStateEqual(INetDeltaBaseState* OtherState) override
 		{
-			SequenceBranch->DeactivateBranches(false);
+			return StateKey == static_cast<FBaseState*>(OtherState)->StateKey;
+		}
+
+		uint32 StateKey;
+		TSharedPtr<const FGameQuestCompactStateData> Data;
+	};
+
+	// Bound of flag and slot num, a quest has at most MAX_uint16 nodes
+	constexpr uint32 MaxNum = MAX_uint16 * 4;
+
+	void WriteIds(FArchive& Ar, const TArray<uint16>& Ids)
+	{
+		uint32 Num = Ids.Num();
+		Ar.SerializeIntPacked(Num);
+		for (const uint16 Id : Ids)
+		{
+			uint32 Value = Id;
+			Ar.SerializeIntPacked(Value);
 		}
 	}
-	for (const uint16 SequenceId : CurActivatedBranches)
+
+	bool ReadIds(FArchive& Ar, TArray<uint16>& Ids)
 	{
-		FGameQuestSequenceBranch* SequenceBranch = GameQuestCastChecked<FGameQuestSequenceBranch>(GetSequencePtr(SequenceId));
-		if (SequenceBranch->bIsBranchesActivated == false)
+		uint32 Num = 0;
+		Ar.SerializeIntPacked(Num);
+		if (Ar.IsError() || Num > MAX_uint16)
 		{
-			SequenceBranch->ActivateBranches(false);
+			return false;
+		}
+		Ids.SetNumUninitialized(Num);
+		for (uint16& Id : Ids)
+		{
+			uint32 Value = 0;
+			Ar.SerializeIntPacked(Value);
+			if (Value > MAX_uint16)
+			{
+				return false;
+			}
+			Id = Value;
+		}
+		return Ar.IsError() == false;
+	}
+
+	void WriteFullState(FBitWriter& Writer, const FGameQuestCompactStateData& Data)
+	{
+		uint32 FlagNum = Data.Flags.Num();
+		Writer.SerializeIntPacked(FlagNum);
+		for (int32 Idx = 0; Idx < Data.Flags.Num(); ++Idx)
+		{
+			Writer.WriteBit(Data.Flags[Idx]);
+		}
+		uint32 SlotNum = Data.Slots.Num();
+		Writer.SerializeIntPacked(SlotNum);
+		for (const TArray<uint16>& Slot : Data.Slots)
+		{
+			// Most slot is empty, one bit for it
+			Writer.WriteBit(Slot.Num() > 0);
+			if (Slot.Num() > 0)
+			{
+				WriteIds(Writer, Slot);
+			}
+		}
+	}
+
+	bool ReadFullState(FBitReader& Reader, FGameQuestCompactStateData& Data)
+	{
+		uint32 FlagNum = 0;
+		Reader.SerializeIntPacked(FlagNum);
+		if (Reader.IsError() || FlagNum > MaxNum)
+		{
+			return false;
+		}
+		Data.Flags.Init(false, FlagNum);
+		for (uint32 Idx = 0; Idx < FlagNum; ++Idx)
+		{
+			Data.Flags[Idx] = Reader.ReadBit() != 0;
+		}
+		uint32 SlotNum = 0;
+		Reader.SerializeIntPacked(SlotNum);
+		if (Reader.IsError() || SlotNum > MaxNum)
+		{
+			return false;
+		}
+		Data.Slots.SetNum(SlotNum);
+		for (TArray<uint16>& Slot : Data.Slots)
+		{
+			Slot.Reset();
+			if (Reader.ReadBit() && ReadIds(Reader, Slot) == false)
+			{
+				return false;
+			}
+		}
+		return Reader.IsError() == false;
+	}
+
+	// Changed flag and slot with its new value, so resend from an older acked base is still right
+	void WriteDeltaState(FBitWriter& Writer, const FGameQuestCompactStateData& OldData, const FGameQuestCompactStateData& Data)
+	{
+		const TBitArray<> ChangedFlags = TBitArray<>::BitwiseXOR(OldData.Flags, Data.Flags, EBitwiseOperatorFlags::MinSize);
+		uint32 ChangedFlagNum = ChangedFlags.CountSetBits();
+		Writer.SerializeIntPacked(ChangedFlagNum);
+		uint32 PreIdx = 0;
+		for (TConstSetBitIterator<> It{ ChangedFlags }; It; ++It)
+		{
+			uint32 Gap = It.GetIndex() - PreIdx;
+			Writer.SerializeIntPacked(Gap);
+			Writer.WriteBit(Data.Flags[It.GetIndex()]);
+			PreIdx = It.GetIndex() + 1;
+		}
+
+		TArray<int32, TInlineAllocator<8>> ChangedSlots;
+		for (int32 Idx = 0; Idx < Data.Slots.Num(); ++Idx)
+		{
+			if (OldData.Slots[Idx] != Data.Slots[Idx])
+			{
+				ChangedSlots.Add(Idx);
+			}
+		}
+		uint32 ChangedSlotNum = ChangedSlots.Num();
+		Writer.SerializeIntPacked(ChangedSlotNum);
+		PreIdx = 0;
+		for (const int32 Idx : ChangedSlots)
+		{
+			uint32 Gap = Idx - PreIdx;
+			Writer.SerializeIntPacked(Gap);
+			WriteIds(Writer, Data.Slots[Idx]);
+			PreIdx = Idx + 1;
+		}
+	}
+
+	bool ReadDeltaState(FBitReader& Reader, FGameQuestCompactStateData& Data)
+	{
+		uint32 ChangedFlagNum = 0;
+		Reader.SerializeIntPacked(ChangedFlagNum);
+		uint32 Idx = 0;
+		for (uint32 Num = 0; Num < ChangedFlagNum; ++Num)
+		{
+			uint32 Gap = 0;
+			Reader.SerializeIntPacked(Gap);
+			if (Reader.IsError() || Gap >= static_cast<uint32>(Data.Flags.Num()) - Idx)
+			{
+				return false;
+			}
+			Idx += Gap;
+			Data.Flags[Idx] = Reader.ReadBit() != 0;
+			Idx += 1;
+		}
+
+		uint32 ChangedSlotNum = 0;
+		Reader.SerializeIntPacked(ChangedSlotNum);
+		Idx = 0;
+		for (uint32 Num = 0; Num < ChangedSlotNum; ++Num)
+		{
+			uint32 Gap = 0;
+			Reader.SerializeIntPacked(Gap);
+			if (Reader.IsError() || Gap >= static_cast<uint32>(Data.Slots.Num()) - Idx)
+			{
+				return false;
+			}
+			Idx += Gap;
+			if (ReadIds(Reader, Data.Slots[Idx]) == false)
+			{
+				return false;
+			}
+			Idx += 1;
+		}
+		return Reader.IsError() == false;
+	}
+}
+
+bool FGameQuestCompactState::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	using namespace GameQuestCompactState;
+	if (DeltaParms.GatherGuidReferences || DeltaParms.MoveGuidToUnmapped || DeltaParms.bUpdateUnmappedObjects)
+	{
+		// Only ids, no object reference to map
+		return false;
+	}
+	if (Owner == nullptr)
+	{
+		return false;
+	}
+
+	if (FBitWriter* Writer = DeltaParms.Writer)
+	{
+		const FBaseState* OldState = static_cast<const FBaseState*>(DeltaParms.OldState);
+		if (OldState && OldState->StateKey == StateKey)
+		{
+			return false;
+		}
+		if (Data == nullptr || DataKey != StateKey)
+		{
+			// Old data is kept by base states, gather to a new one
+			Data = MakeShared<FGameQuestCompactStateData>();
+			Owner->GatherCompactState(*Data);
+			DataKey = StateKey;
+		}
+		*DeltaParms.NewState = MakeShared<FBaseState>(StateKey, Data);
+
+		const FGameQuestCompactStateData* OldData = OldState ? OldState->Data.Get() : nullptr;
+		const bool bFullState = OldData == nullptr || OldData->Flags.Num() != Data->Flags.Num() || OldData->Slots.Num() != Data->Slots.Num();
+		Writer->WriteBit(bFullState);
+		if (bFullState)
+		{
+			WriteFullState(*Writer, *Data);
+		}
+		else
+		{
+			WriteDeltaState(*Writer, *OldData, *Data);
+		}
+		return true;
+	}
+
+	if (FBitReader* Reader = DeltaParms.Reader)
+	{
+		FGameQuestCompactStateData NewData = Data ? *Data : FGameQuestCompactStateData{};
+		const bool bFullState = Reader->ReadBit() != 0;
+		const bool bSuccess = bFullState ? ReadFullState(*Reader, NewData) : ReadDeltaState(*Reader, NewData);
+		if (bSuccess == false || Reader->IsError())
+		{
+			UE_LOG(LogGameQuest, Warning, TEXT("%s read compact state failed"), *Owner->GetName());
+			Reader->SetError();
+			return false;
+		}
+		const TSharedPtr<FGameQuestCompactStateData> PreData = Data;
+		Data = MakeShared<FGameQuestCompactStateData>(MoveTemp(NewData));
+		Owner->ApplyCompactState(PreData.Get(), *Data);
+		return true;
+	}
+	return false;
+}
+
+void UGameQuestGraphBase::GatherCompactState(FGameQuestCompactStateData& Data) const
+{
+	using ESequenceKind = UGameQuestGraphGeneratedClass::FCompactStateLayout::ESequenceKind;
+	const UGameQuestGraphGeneratedClass* Class = CastChecked<UGameQuestGraphGeneratedClass>(GetClass());
+	const UGameQuestGraphGeneratedClass::FCompactStateLayout& Layout = Class->CompactStateLayout;
+	if (!ensure(Class->IsRuntimeTablesBuilt()))
+	{
+		return;
+	}
+	Data.Flags.Init(false, Layout.FlagNum);
+	Data.Slots.SetNum(Layout.SlotNum);
+
+	int32 FlagIdx = 0;
+	int32 SlotIdx = 0;
+	Data.Flags[FlagIdx++] = bInterrupted != 0;
+	Data.Slots[SlotIdx++] = StartSequences;
+	for (const uint16 ElementId : Layout.Elements)
+	{
+		Data.Flags[FlagIdx++] = GetElementPtr(ElementId)->bIsFinished != 0;
+	}
+	for (const UGameQuestGraphGeneratedClass::FCompactStateLayout::FSequence& Entry : Layout.Sequences)
+	{
+		const FGameQuestSequenceBase* Sequence = GetSequencePtr(Entry.Id);
+		Data.Flags[FlagIdx++] = Sequence->bInterrupted != 0;
+		Data.Flags[FlagIdx++] = IsSequenceIdActivated(Entry.Id);
+		TArray<uint16>& PreSequenceSlot = Data.Slots[SlotIdx++];
+		PreSequenceSlot.Reset();
+		if (Sequence->PreSequence != GameQuest::IdNone)
+		{
+			PreSequenceSlot.Add(Sequence->PreSequence);
+		}
+		switch (Entry.Kind)
+		{
+		case ESequenceKind::Single:
+			Data.Slots[SlotIdx++] = static_cast<const FGameQuestSequenceSingle*>(Sequence)->NextSequences;
+			break;
+		case ESequenceKind::List:
+			Data.Slots[SlotIdx++] = static_cast<const FGameQuestSequenceList*>(Sequence)->NextSequences;
+			break;
+		case ESequenceKind::Branch:
+		{
+			Data.Flags[FlagIdx++] = IsBranchIdActivated(Entry.Id);
+			const FGameQuestSequenceBranch* SequenceBranch = static_cast<const FGameQuestSequenceBranch*>(Sequence);
+			for (int32 BranchIndex = 0; BranchIndex < Entry.BranchNum; ++BranchIndex)
+			{
+				Data.Slots[SlotIdx++] = SequenceBranch->Branches[BranchIndex].NextSequences;
+			}
+			break;
+		}
+		default:
+			break;
+		}
+	}
+	check(FlagIdx == Layout.FlagNum && SlotIdx == Layout.SlotNum);
+}
+
+void UGameQuestGraphBase::ApplyCompactState(const FGameQuestCompactStateData* PreData, const FGameQuestCompactStateData& Data)
+{
+	using ESequenceKind = UGameQuestGraphGeneratedClass::FCompactStateLayout::ESequenceKind;
+	const UGameQuestGraphGeneratedClass* Class = CastChecked<UGameQuestGraphGeneratedClass>(GetClass());
+	const UGameQuestGraphGeneratedClass::FCompactStateLayout& Layout = Class->CompactStateLayout;
+	if (Data.Flags.Num() != Layout.FlagNum || Data.Slots.Num() != Layout.SlotNum)
+	{
+		UE_LOG(LogGameQuest, Warning, TEXT("%s compact state layout mismatch, server and client quest class are different"), *GetName());
+		return;
+	}
+	if (PreData && (PreData->Flags.Num() != Data.Flags.Num() || PreData->Slots.Num() != Data.Slots.Num()))
+	{
+		PreData = nullptr;
+	}
+	// Only changed value is applied like property replication, keep client local value of unchanged one
+	auto IsFlagChanged = [&](int32 Idx) { return PreData == nullptr || PreData->Flags[Idx] != Data.Flags[Idx]; };
+	auto IsSlotChanged = [&](int32 Idx) { return PreData == nullptr || PreData->Slots[Idx] != Data.Slots[Idx]; };
+	// Changed node get WhenOnRepValue with its previous value, same as node property replication
+	auto SnapshotNode = [](const FGameQuestNodeBase& Node)
+	{
+		const UScriptStruct* NodeStruct = Node.GetNodeStruct();
+		TUniquePtr<FStructOnScope> PreValue = MakeUnique<FStructOnScope>(NodeStruct);
+		NodeStruct->CopyScriptStruct(PreValue->GetStructMemory(), &Node);
+		return PreValue;
+	};
+	auto NotifyNodeRep = [](FGameQuestNodeBase& Node, const FStructOnScope& PreValue)
+	{
+		Node.WhenOnRepValue(*reinterpret_cast<const FGameQuestNodeBase*>(PreValue.GetStructMemory()));
+	};
+
+	int32 FlagIdx = 0;
+	int32 SlotIdx = 0;
+	bInterrupted = Data.Flags[FlagIdx++];
+	if (IsSlotChanged(SlotIdx))
+	{
+		StartSequences = Data.Slots[SlotIdx];
+	}
+	SlotIdx += 1;
+	for (const uint16 ElementId : Layout.Elements)
+	{
+		const bool bFinished = Data.Flags[FlagIdx];
+		FGameQuestElementBase* Element = GetElementPtr(ElementId);
+		if (IsFlagChanged(FlagIdx++) && Element->bIsFinished != bFinished)
+		{
+			const TUniquePtr<FStructOnScope> PreValue = SnapshotNode(*Element);
+			Element->bIsFinished = bFinished;
+			NotifyNodeRep(*Element, *PreValue);
+		}
+	}
+
+	bool bActivatedSequencesChanged = false;
+	bool bActivatedBranchesChanged = false;
+	TArray<uint16> NewActivatedSequences;
+	TArray<uint16> NewActivatedBranches;
+	// Sequence state depend on activated sequences, notified after them applied
+	TArray<TPair<FGameQuestSequenceBase*, TUniquePtr<FStructOnScope>>> ChangedSequences;
+	for (const UGameQuestGraphGeneratedClass::FCompactStateLayout::FSequence& Entry : Layout.Sequences)
+	{
+		FGameQuestSequenceBase* Sequence = GetSequencePtr(Entry.Id);
+		const int32 SequenceSlotNum = 1 + (Entry.Kind == ESequenceKind::Single || Entry.Kind == ESequenceKind::List ? 1 : Entry.Kind == ESequenceKind::Branch ? Entry.BranchNum : 0);
+		bool bSequenceChanged = Sequence->bInterrupted != Data.Flags[FlagIdx];
+		for (int32 Idx = SlotIdx; Idx < SlotIdx + SequenceSlotNum && bSequenceChanged == false; ++Idx)
+		{
+			bSequenceChanged = IsSlotChanged(Idx);
+		}
+		if (bSequenceChanged)
+		{
+			ChangedSequences.Emplace(Sequence, SnapshotNode(*Sequence));
+		}
+		Sequence->bInterrupted = Data.Flags[FlagIdx++];
+		bActivatedSequencesChanged |= IsFlagChanged(FlagIdx);
+		if (Data.Flags[FlagIdx++])
+		{
+			NewActivatedSequences.Add(Entry.Id);
+		}
+		if (IsSlotChanged(SlotIdx))
+		{
+			const TArray<uint16>& PreSequenceSlot = Data.Slots[SlotIdx];
+			Sequence->PreSequence = PreSequenceSlot.Num() > 0 ? PreSequenceSlot[0] : GameQuest::IdNone;
+		}
+		SlotIdx += 1;
+		switch (Entry.Kind)
+		{
+		case ESequenceKind::Single:
+			if (IsSlotChanged(SlotIdx))
+			{
+				static_cast<FGameQuestSequenceSingle*>(Sequence)->NextSequences = Data.Slots[SlotIdx];
+			}
+			SlotIdx += 1;
+			break;
+		case ESequenceKind::List:
+			if (IsSlotChanged(SlotIdx))
+			{
+				static_cast<FGameQuestSequenceList*>(Sequence)->NextSequences = Data.Slots[SlotIdx];
+			}
+			SlotIdx += 1;
+			break;
+		case ESequenceKind::Branch:
+		{
+			bActivatedBranchesChanged |= IsFlagChanged(FlagIdx);
+			if (Data.Flags[FlagIdx++])
+			{
+				NewActivatedBranches.Add(Entry.Id);
+			}
+			FGameQuestSequenceBranch* SequenceBranch = static_cast<FGameQuestSequenceBranch*>(Sequence);
+			for (int32 BranchIndex = 0; BranchIndex < Entry.BranchNum; ++BranchIndex)
+			{
+				if (IsSlotChanged(SlotIdx))
+				{
+					SequenceBranch->Branches[BranchIndex].NextSequences = Data.Slots[SlotIdx];
+				}
+				SlotIdx += 1;
+			}
+			break;
+		}
+		default:
+			break;
 		}
 	}
 
-	PreActivatedBranches = ::MoveTemp(ActivatedBranchesSet);
+	if (bActivatedSequencesChanged)
+	{
+		ActivatedSequences = MoveTemp(NewActivatedSequences);
+		OnRep_ActivatedSequences();
+	}
+	if (bActivatedBranchesChanged)
+	{
+		ActivatedBranches = MoveTemp(NewActivatedBranches);
+		OnRep_ActivatedBranches();
+	}
+	for (const TPair<FGameQuestSequenceBase*, TUniquePtr<FStructOnScope>>& ChangedSequence : ChangedSequences)
+	{
+		NotifyNodeRep(*ChangedSequence.Key, *ChangedSequence.Value);
+	}
+	for (const UGameQuestGraphGeneratedClass::FCompactStateLayout::FSequence& Entry : Layout.Sequences)
+	{
+		GetSequencePtr(Entry.Id)->RefreshSequenceState();
+	}
 }
 
-void UGameQuestGraphBase::Tick(float DeltaSeconds)
+void FGameQuestSuccessorSink::Add(uint16 SequenceId) const
 {
-	for (int32 Idx = TickableSequences.Num() - 1; Idx >= 0 && Idx < TickableSequences.Num(); ++Idx)
+	check(NextSequences);
+	NextSequences->Add(SequenceId);
+	if (Node)
+	{
+		Node->MarkNodeNetDirty();
+	}
+	else if (Quest)
 	{
-		FGameQuestSequenceBase* Sequence = TickableSequences[Idx];
-		Sequence->Tick(DeltaSeconds);
+		MARK_PROPERTY_DIRTY_FROM_NAME(UGameQuestGraphBase, StartSequences, Quest);
+		Quest->MarkCompactStateDirty();
+		Quest->MarkSaveStateDirty();
 	}
-	for (int32 Idx = TickableElements.Num() - 1; Idx >= 0 && Idx < TickableElements.Num(); --Idx)
+}
+
+FGameQuestExecutionContext& UGameQuestGraphBase::GetExecutionContext()
+{
+	UGameQuestGraphBase* RootQuest = this;
+	while (UGameQuestGraphBase* OwnerQuest = Cast<UGameQuestGraphBase>(RootQuest->Owner))
 	{
-		FGameQuestElementBase* Element = TickableElements[Idx];
-		Element->Tick(DeltaSeconds);
+		RootQuest = OwnerQuest;
+	}
+	return RootQuest->ExecutionContext;
+}
+
+bool UGameQuestGraphBase::PrepareListFinishedMasks()
+{
+	if (bListFinishedMasksDirty == false)
+	{
+		return bUseListFinishedMasks;
+	}
+	bListFinishedMasksDirty = false;
+	ListFinishedMasks.Reset();
+	const UGameQuestGraphGeneratedClass* Class = Cast<UGameQuestGraphGeneratedClass>(GetClass());
+	// Client element state could replicate after the list state, keep walk the elements
+	bUseListFinishedMasks = Class && HasAuthority();
+	if (bUseListFinishedMasks)
+	{
+		ListFinishedMasks.SetNumZeroed(Class->ListLogicMasks.Num());
+		for (int32 ElementId = 0; ElementId < Class->ElementListBits.Num(); ++ElementId)
+		{
+			const UGameQuestGraphGeneratedClass::FElementListBit& ListBit = Class->ElementListBits[ElementId];
+			if (ListBit.Slot != INDEX_NONE && GetElementPtr(ElementId)->bIsFinished)
+			{
+				ListFinishedMasks[ListBit.Slot] |= uint64(1) << ListBit.Bit;
+			}
+		}
+	}
+	return bUseListFinishedMasks;
+}
+
+void UGameQuestGraphBase::SetElementFinishedBit(uint16 ElementId, bool bFinished)
+{
+	if (bListFinishedMasksDirty || bUseListFinishedMasks == false)
+	{
+		return;
+	}
+	const UGameQuestGraphGeneratedClass* Class = static_cast<const UGameQuestGraphGeneratedClass*>(GetClass());
+	if (Class->ElementListBits.IsValidIndex(ElementId) == false)
+	{
+		return;
+	}
+	const UGameQuestGraphGeneratedClass::FElementListBit& ListBit = Class->ElementListBits[ElementId];
+	if (ListBit.Slot == INDEX_NONE)
+	{
+		return;
+	}
+	if (bFinished)
+	{
+		ListFinishedMasks[ListBit.Slot] |= uint64(1) << ListBit.Bit;
+	}
+	else
+	{
+		ListFinishedMasks[ListBit.Slot] &= ~(uint64(1) << ListBit.Bit);
+	}
+}
+
+bool UGameQuestGraphBase::CanFinishListByMask(uint16 ListId, bool& bCanFinish)
+{
+	if (PrepareListFinishedMasks() == false)
+	{
+		return false;
+	}
+	const UGameQuestGraphGeneratedClass* Class = static_cast<const UGameQuestGraphGeneratedClass*>(GetClass());
+	const int32 Slot = Class->NodeIdListSlots.IsValidIndex(ListId) ? Class->NodeIdListSlots[ListId] : INDEX_NONE;
+	if (Slot == INDEX_NONE)
+	{
+		return false;
+	}
+	const uint64 FinishedMask = ListFinishedMasks[Slot];
+	bCanFinish = Class->ListLogicMasks[Slot].GroupMasks.ContainsByPredicate([FinishedMask](uint64 GroupMask) { return (FinishedMask & GroupMask) == GroupMask; });
+	return true;
+}
+
+void UGameQuestGraphBase::RefreshSequenceStates()
+{
+	for (TFieldIterator<FStructProperty> It{ GetClass() }; It; ++It)
+	{
+		if (It->Struct->IsChildOf(FGameQuestSequenceBase::StaticStruct()))
+		{
+			It->ContainerPtrToValuePtr<FGameQuestSequenceBase>(this)->RefreshSequenceState();
+		}
+	}
+}
+
+void UGameQuestGraphBase::OnRep_StartSequences()
+{
+	for (const uint16 SequenceId : StartSequences)
+	{
+		GetSequencePtr(SequenceId)->RefreshSequenceState();
+	}
+}
+
+void UGameQuestGraphBase::OnRep_ActivatedSequences()
+{
+	TBitArray<> ChangedBits;
+	if (SequencePrediction.FromSequence != GameQuest::IdNone && ActivatedSequences.Contains(SequencePrediction.FromSequence))
+	{
+		// Server not processed the predicted finish yet, keep the predicted transition over the replicated state
+		TArray<uint16> PredictedSequences{ ActivatedSequences };
+		PredictedSequences.RemoveSingle(SequencePrediction.FromSequence);
+		PredictedSequences.AddUnique(SequencePrediction.ToSequence);
+		ChangedBits = UpdateActivatedBits(ActivatedSequenceBits, PredictedSequences);
+	}
+	else
+	{
+		// Predicted transition confirmed or the replicated one roll it back
+		ClearSequencePrediction();
+		ChangedBits = UpdateActivatedBits(ActivatedSequenceBits, ActivatedSequences);
+	}
+
+	for (TConstSetBitIterator<> It{ ChangedBits }; It; ++It)
+	{
+		const uint16 SequenceId = It.GetIndex();
+		if (IsSequenceIdActivated(SequenceId) == false)
+		{
+			FGameQuestSequenceBase* Sequence = GetSequencePtr(SequenceId);
+			Sequence->OnRepDeactivateSequence(SequenceId);
+		}
+	}
+	for (TConstSetBitIterator<> It{ ChangedBits }; It; ++It)
+	{
+		const uint16 SequenceId = It.GetIndex();
+		if (IsSequenceIdActivated(SequenceId))
+		{
+			FGameQuestSequenceBase* Sequence = GetSequencePtr(SequenceId);
+			Sequence->OnRepActivateSequence(SequenceId);
+		}
+	}
+}
+
+bool UGameQuestGraphBase::PredictElementFinished(const FGameQuestElementBase& Element, const FName& EventName)
+{
+	if (Element.bIsOptional || SequencePrediction.FromSequence != GameQuest::IdNone)
+	{
+		return false;
+	}
+	const uint16 SequenceId = Element.Sequence;
+	FGameQuestSequenceBase* Sequence = GetSequencePtr(SequenceId);
+	// List finish depend on other elements and branch on the branch logic, only single sequence finish is deterministic
+	if (GameQuestCast<FGameQuestSequenceSingle>(Sequence) == nullptr || IsSequenceIdActivated(SequenceId) == false)
+	{
+		return false;
+	}
+
+	// Only predict the event connect to exactly one sequence, logic in event graph is not predicted and rollback when server differ
+	const UGameQuestGraphGeneratedClass* Class = static_cast<const UGameQuestGraphGeneratedClass*>(GetClass());
+	const uint16 ElementId = GetElementId(&Element);
+	const auto* EventNameNodeIds = Class->NodeIdEventNameMap.Find(ElementId);
+	if (EventNameNodeIds == nullptr)
+	{
+		return false;
+	}
+	uint16 NextSequenceId = GameQuest::IdNone;
+	for (const UGameQuestGraphGeneratedClass::FEventNameNodeId& EventNameNodeId : *EventNameNodeIds)
+	{
+		if (EventNameNodeId.EventName != EventName)
+		{
+			continue;
+		}
+		if (NextSequenceId != GameQuest::IdNone || Class->NodeTable.IsValidIndex(EventNameNodeId.NodeId) == false || Class->NodeTable[EventNameNodeId.NodeId].Kind != UGameQuestGraphGeneratedClass::ENodeKind::Sequence)
+		{
+			return false;
+		}
+		NextSequenceId = EventNameNodeId.NodeId;
+	}
+	if (NextSequenceId == GameQuest::IdNone)
+	{
+		return false;
+	}
+	FGameQuestSequenceBase* NextSequence = GetSequencePtr(NextSequenceId);
+	if (NextSequence->bIsActivated || (GameQuestCast<FGameQuestSequenceSingle>(NextSequence) == nullptr && GameQuestCast<FGameQuestSequenceList>(NextSequence) == nullptr))
+	{
+		return false;
+	}
+
+	UE_LOG(LogGameQuest, Verbose, TEXT("Predict %s.%s -> %s"), *GetName(), *Sequence->GetNodeName().ToString(), *NextSequence->GetNodeName().ToString());
+	SequencePrediction.FromSequence = SequenceId;
+	SequencePrediction.ToSequence = NextSequenceId;
+	SequencePrediction.Element = ElementId;
+	SetActivatedBit(ActivatedSequenceBits, SequenceId, false);
+	Sequence->OnRepDeactivateSequence(SequenceId);
+	SetActivatedBit(ActivatedSequenceBits, NextSequenceId, true);
+	NextSequence->OnRepActivateSequence(NextSequenceId);
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().SetTimer(SequencePrediction.TimeoutHandle, FTimerDelegate::CreateUObject(this, &UGameQuestGraphBase::WhenSequencePredictionTimeout), FMath::Max(CVarGameQuestPredictionTimeout.GetValueOnGameThread(), 0.01f), false);
+	}
+	return true;
+}
+
+void UGameQuestGraphBase::ClearSequencePrediction()
+{
+	if (SequencePrediction.FromSequence == GameQuest::IdNone)
+	{
+		return;
+	}
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(SequencePrediction.TimeoutHandle);
+	}
+	SequencePrediction = FSequencePrediction{};
+}
+
+void UGameQuestGraphBase::WhenSequencePredictionTimeout()
+{
+	if (SequencePrediction.FromSequence == GameQuest::IdNone)
+	{
+		return;
+	}
+	UE_LOG(LogGameQuest, Verbose, TEXT("Prediction timeout %s, rollback to replicated state"), *GetName());
+	const bool bRollbackElement = ActivatedSequences.Contains(SequencePrediction.FromSequence);
+	FGameQuestElementBase* Element = GetElementPtr(SequencePrediction.Element);
+	ClearSequencePrediction();
+	if (bRollbackElement && Element->bIsFinished)
+	{
+		// Server not accept the finish, element is activated again by the rollback
+		Element->bIsFinished = false;
+		Element->WhenUnfinished();
+	}
+	OnRep_ActivatedSequences();
+}
+
+void UGameQuestGraphBase::OnRep_ActivatedBranches()
+{
+	const TBitArray<> ChangedBits = UpdateActivatedBits(ActivatedBranchBits, ActivatedBranches);
+
+	for (TConstSetBitIterator<> It{ ChangedBits }; It; ++It)
+	{
+		const uint16 SequenceId = It.GetIndex();
+		FGameQuestSequenceBranch* SequenceBranch = GameQuestCastChecked<FGameQuestSequenceBranch>(GetSequencePtr(SequenceId));
+		if (IsBranchIdActivated(SequenceId) == false && SequenceBranch->bIsBranchesActivated)
+		{
+			SequenceBranch->DeactivateBranches(false);
+		}
+	}
+	for (TConstSetBitIterator<> It{ ChangedBits }; It; ++It)
+	{
+		const uint16 SequenceId = It.GetIndex();
+		FGameQuestSequenceBranch* SequenceBranch = GameQuestCastChecked<FGameQuestSequenceBranch>(GetSequencePtr(SequenceId));
+		if (IsBranchIdActivated(SequenceId) && SequenceBranch->bIsBranchesActivated == false)
+		{
+			SequenceBranch->ActivateBranches(false);
+		}
 	}
 }
 
 void UGameQuestGraphBase::SetElementFinishedToServer_Implementation(const uint16 ElementId, const FName& EventName)
 {
-	FGameQuestElementBase* Element = GetElementPtr(ElementId);
-	if (!ensure(Element && GetSequencePtr(Element->Sequence)->bIsActivated))
+	FGameQuestElementBase* Element = FindElementPtr(ElementId);
+	if (Element == nullptr)
 	{
+		UE_LOG(LogGameQuest, Warning, TEXT("Server Receive Finish %s invalid element %d"), *GetName(), ElementId);
 		return;
 	}
-	if (!Element->bIsActivated)
+	// Client could send it before it know the sequence deactivated
+	if (GetSequencePtr(Element->Sequence)->bIsActivated == false || !Element->bIsActivated)
 	{
 		return;
 	}
@@ -207,12 +1109,13 @@ void UGameQuestGraphBase::SetElementFinishedToServer_Implementation(const uint16
 
 void UGameQuestGraphBase::SetElementUnfinishedToServer_Implementation(const uint16 ElementId)
 {
-	FGameQuestElementBase* Element = GetElementPtr(ElementId);
-	if (!ensure(Element && GetSequencePtr(Element->Sequence)->bIsActivated))
+	FGameQuestElementBase* Element = FindElementPtr(ElementId);
+	if (Element == nullptr)
 	{
+		UE_LOG(LogGameQuest, Warning, TEXT("Server Receive Cancel Finish %s invalid element %d"), *GetName(), ElementId);
 		return;
 	}
-	if (!Element->bIsActivated)
+	if (GetSequencePtr(Element->Sequence)->bIsActivated == false || !Element->bIsActivated)
 	{
 		return;
 	}
@@ -237,6 +1140,8 @@ void UGameQuestGraphBase::ReactiveQuest()
 		if (ensure(Sequence->bIsActivated == false))
 		{
 			Sequence->bIsActivated = true;
+			Sequence->RefreshSequenceState();
+			Sequence->RegisterTick();
 			Sequence->WhenSequenceActivated(bHasAuthority);
 		}
 	}
@@ -255,6 +1160,8 @@ void UGameQuestGraphBase::DeactivateQuest()
 		if (ensure(Sequence->bIsActivated))
 		{
 			Sequence->bIsActivated = false;
+			Sequence->RefreshSequenceState();
+			Sequence->UnregisterTick();
 			Sequence->WhenSequenceDeactivated(bHasAuthority);
 		}
 	}
@@ -288,38 +1195,42 @@ void UGameQuestGraphBase::PostSequenceDeactivated(FGameQuestSequenceBase* Sequen
 
 FGameQuestSequenceBase* UGameQuestGraphBase::GetSequencePtr(uint16 Id) const
 {
-	UGameQuestGraphGeneratedClass* Class = CastChecked<UGameQuestGraphGeneratedClass>(GetClass());
-	const FStructProperty* SequenceProperty = Class->NodeIdPropertyMap[Id];
-	check(SequenceProperty->Struct->IsChildOf(FGameQuestSequenceBase::StaticStruct()));
-	const FGameQuestSequenceBase* Sequence = SequenceProperty->ContainerPtrToValuePtr<FGameQuestSequenceBase>(this);
-	return const_cast<FGameQuestSequenceBase*>(Sequence);
+	checkSlow(GetClass()->IsA<UGameQuestGraphGeneratedClass>());
+	const UGameQuestGraphGeneratedClass* Class = static_cast<const UGameQuestGraphGeneratedClass*>(GetClass());
+	return Class->GetNodePtr<FGameQuestSequenceBase>(this, Id, UGameQuestGraphGeneratedClass::ENodeKind::Sequence);
 }
 
 FGameQuestElementBase* UGameQuestGraphBase::GetElementPtr(uint16 Id) const
 {
-	UGameQuestGraphGeneratedClass* Class = CastChecked<UGameQuestGraphGeneratedClass>(GetClass());
-	const FStructProperty* ElementProperty = Class->NodeIdPropertyMap[Id];
-	check(ElementProperty->Struct->IsChildOf(FGameQuestElementBase::StaticStruct()));
-	const FGameQuestElementBase* Element = ElementProperty->ContainerPtrToValuePtr<FGameQuestElementBase>(this);
-	return const_cast<FGameQuestElementBase*>(Element);
+	checkSlow(GetClass()->IsA<UGameQuestGraphGeneratedClass>());
+	const UGameQuestGraphGeneratedClass* Class = static_cast<const UGameQuestGraphGeneratedClass*>(GetClass());
+	return Class->GetNodePtr<FGameQuestElementBase>(this, Id, UGameQuestGraphGeneratedClass::ENodeKind::Element);
+}
+
+FGameQuestElementBase* UGameQuestGraphBase::FindElementPtr(uint16 Id) const
+{
+	const UGameQuestGraphGeneratedClass* Class = Cast<UGameQuestGraphGeneratedClass>(GetClass());
+	if (Class == nullptr || Class->NodeTable.IsValidIndex(Id) == false || Class->NodeTable[Id].Kind != UGameQuestGraphGeneratedClass::ENodeKind::Element)
+	{
+		return nullptr;
+	}
+	return GetElementPtr(Id);
 }
 
 const GameQuest::FLogicList& UGameQuestGraphBase::GetLogicList(const FGameQuestNodeBase* Node) const
 {
-	UGameQuestGraphGeneratedClass* Class = CastChecked<UGameQuestGraphGeneratedClass>(GetClass());
-	return Class->NodeIdLogicsMap[Class->NodeNameIdMap[Node->GetNodeName()]];
+	check(Node->LogicList);
+	return *Node->LogicList;
 }
 
 uint16 UGameQuestGraphBase::GetSequenceId(const FGameQuestSequenceBase* Sequence) const
 {
-	UGameQuestGraphGeneratedClass* Class = CastChecked<UGameQuestGraphGeneratedClass>(GetClass());
-	return Class->NodeNameIdMap[Sequence->GetNodeName()];
+	return Sequence->NodeId;
 }
 
 uint16 UGameQuestGraphBase::GetElementId(const FGameQuestElementBase* Element) const
 {
-	UGameQuestGraphGeneratedClass* Class = CastChecked<UGameQuestGraphGeneratedClass>(GetClass());
-	return Class->NodeNameIdMap[Element->GetNodeName()];
+	return Element->NodeId;
 }
 
 TArray<FName> UGameQuestGraphBase::GetRerouteTagNames() const
@@ -355,6 +1266,36 @@ void UGameQuestGraphBase::BindingRerouteTags()
 	}
 }
 
+void UGameQuestGraphBase::MarkNodeSaveStateDirty(uint16 NodeId)
+{
+	// Only server state is saved
+	if (HasAuthority() == false)
+	{
+		return;
+	}
+	UGameQuestGraphBase* MainQuest;
+	const UGameQuestComponent* Component = GetComponent(MainQuest);
+	if (Component && Component->bSuppressSaveStateDirty)
+	{
+		return;
+	}
+	const uint32 Generation = Component ? Component->SaveGeneration : 0;
+	SaveGeneration = Generation;
+	if (NodeId != GameQuest::IdNone)
+	{
+		if (NodeSaveGenerations.Num() <= NodeId)
+		{
+			NodeSaveGenerations.SetNumZeroed(NodeId + 1);
+		}
+		NodeSaveGenerations[NodeId] = Generation;
+	}
+	// Sub quest is saved in the record of its sequence
+	if (UGameQuestGraphBase* OwnerQuest = Cast<UGameQuestGraphBase>(Owner); OwnerQuest && OwnerNode)
+	{
+		OwnerQuest->MarkNodeSaveStateDirty(OwnerNode->GetNodeId());
+	}
+}
+
 UGameQuestComponent* UGameQuestGraphBase::GetComponent(UGameQuestGraphBase*& MainQuest) const
 {
 	MainQuest = const_cast<UGameQuestGraphBase*>(this);
@@ -410,6 +1351,11 @@ void UGameQuestGraphBase::InterruptQuest()
 	{
 		return;
 	}
+	if (UGameQuestTickManager* EventQueue = UGameQuestTickManager::GetDeferredEventQueue(this))
+	{
+		EventQueue->EnqueueInterruptQuest(*this);
+		return;
+	}
 	for (const uint16 SequenceId : ActivatedSequences)
 	{
 		FGameQuestSequenceBase* Sequence = GetSequencePtr(SequenceId);
@@ -474,6 +1420,11 @@ void UGameQuestGraphBase::InterruptSequence(FGameQuestSequenceBase& Sequence)
 	{
 		return;
 	}
+	if (UGameQuestTickManager* EventQueue = UGameQuestTickManager::GetDeferredEventQueue(this))
+	{
+		EventQueue->EnqueueInterruptSequence(Sequence);
+		return;
+	}
 	const FGameQuestSequenceBase::EState SequenceState = Sequence.GetSequenceState();
 	if (SequenceState == FGameQuestSequenceBase::EState::Interrupted)
 	{
@@ -497,6 +1448,11 @@ void UGameQuestGraphBase::InterruptBranch(FGameQuestElementBase& Element)
 	{
 		return;
 	}
+	if (UGameQuestTickManager* EventQueue = UGameQuestTickManager::GetDeferredEventQueue(this))
+	{
+		EventQueue->EnqueueInterruptBranch(Element);
+		return;
+	}
 	FGameQuestSequenceBranch* SequenceBranch = GameQuestCast<FGameQuestSequenceBranch>(GetSequencePtr(Element.Sequence));
 	if (!ensure(SequenceBranch))
 	{
@@ -507,8 +1463,7 @@ void UGameQuestGraphBase::InterruptBranch(FGameQuestElementBase& Element)
 	{
 		return;
 	}
-	const uint16 ElementId = GetElementId(&Element);
-	FGameQuestSequenceBranchElement* Branch = SequenceBranch->Branches.FindByPredicate([&](const FGameQuestSequenceBranchElement& E){ return E.Element == ElementId; });
+	FGameQuestSequenceBranchElement* Branch = SequenceBranch->FindBranch(GetElementId(&Element));
 	if (!ensure(Branch))
 	{
 		return;
@@ -632,7 +1587,7 @@ void UGameQuestGraphBase::ForceActivateBranchToServer_Implementation(const uint1
 	{
 		return;
 	}
-	const FGameQuestSequenceBranchElement* Branch = SequenceBranch->Branches.FindByPredicate([&](const FGameQuestSequenceBranchElement& E){ return E.Element == ElementBranchId; });
+	const FGameQuestSequenceBranchElement* Branch = SequenceBranch->FindBranch(ElementBranchId);
 	if (!ensure(Branch))
 	{
 		return;
@@ -694,50 +1649,33 @@ void UGameQuestGraphBase::ForceActivateSequenceToServer_Implementation(const uin
 		return;
 	}
 	const UGameQuestGraphGeneratedClass* Class = CastChecked<UGameQuestGraphGeneratedClass>(GetClass());
-	struct FSequenceSearcher
-	{
-		UGameQuestGraphBase& Quest;
-		const UGameQuestGraphGeneratedClass& Class;
-		TArray<uint16> PendingActivatedIds;
-
-		bool Search(const uint16 NodeId, TSet<uint16>& Visited)
+	const UGameQuestGraphGeneratedClass::FSuccessorGraph& Graph = Class->GetSuccessorGraph();
+	// Nearest activated sequence, no other activated sequence could be on its shortest path
+	uint16 NearestId = GameQuest::IdNone;
+	uint16 NearestDistance = UGameQuestGraphGeneratedClass::FSuccessorGraph::Unreachable;
+	for (const uint16 ActivatedId : ActivatedSequences)
+	{
+		const uint16 Distance = Graph.GetDistance(ActivatedId, SequenceId);
+		if (Distance < NearestDistance)
 		{
-			if (Visited.Contains(NodeId))
-			{
-				return false;
-			}
-			Visited.Add(NodeId);
-			if (Quest.ActivatedSequences.Contains(NodeId))
-			{
-				PendingActivatedIds.Add(NodeId);
-				return true;
-			}
-			const auto* FromNodes = Class.NodeToPredecessorMap.Find(NodeId);
-			if (FromNodes == nullptr)
-			{
-				return false;
-			}
-			for (const uint16 FromNodeId : *FromNodes)
-			{
-				if (Search(FromNodeId, Visited))
-				{
-					PendingActivatedIds.Add(NodeId);
-					return true;
-				}
-			}
-			return false;
+			NearestId = ActivatedId;
+			NearestDistance = Distance;
 		}
-	};
-	FSequenceSearcher Searcher{ *this, *Class };
-	{
-		TSet<uint16> Visited;
-		Searcher.Search(SequenceId, Visited);
 	}
-	const TArray<uint16>& PendingActivatedIds = Searcher.PendingActivatedIds;
-	if (!ensure(PendingActivatedIds.Num() > 0))
+	if (!ensure(NearestId != GameQuest::IdNone))
 	{
 		return;
 	}
+	TArray<uint16, TInlineAllocator<16>> PendingActivatedIds;
+	PendingActivatedIds.Reserve(NearestDistance + 1);
+	for (uint16 NodeId = NearestId; ; NodeId = Graph.GetNextHop(NodeId, SequenceId))
+	{
+		PendingActivatedIds.Add(NodeId);
+		if (NodeId == SequenceId)
+		{
+			break;
+		}
+	}
 	UE_LOG(LogGameQuest, Verbose, TEXT("ForceActivateSequence %s.%s"), *GetName(), *TargetSequence->GetNodeName().ToString());
 	struct FLocal
 	{
@@ -771,7 +1709,7 @@ void UGameQuestGraphBase::ForceActivateSequenceToServer_Implementation(const uin
 			}
 			const UGameQuestGraphGeneratedClass* SubClass = CastChecked<UGameQuestGraphGeneratedClass>(SubQuestInstance->GetClass());
 			const auto [EventName, ToActivateId] = SubClass->RerouteTagPreNodesMap[RerouteTag][0];
-			if (SubClass->NodeIdPropertyMap[ToActivateId]->Struct->IsChildOf(FGameQuestSequenceBase::StaticStruct()))
+			if (SubClass->NodeTable[ToActivateId].Kind == UGameQuestGraphGeneratedClass::ENodeKind::Sequence)
 			{
 				SubQuestInstance->ForceActivateSequenceToServer(ToActivateId);
 				const FGameQuestSequenceBase* SubSequence = SubQuestInstance->GetSequencePtr(ToActivateId);
@@ -821,9 +1759,7 @@ void UGameQuestGraphBase::ForceActivateSequenceToServer_Implementation(const uin
 
 		if (const FGameQuestSequenceSingle* SequenceSingle = GameQuestCast<FGameQuestSequenceSingle>(Sequence))
 		{
-			using FEventNameToNextNode = UGameQuestGraphGeneratedClass::FEventNameNodeId;
-			const FEventNameToNextNode* EventName = Class->NodeIdEventNameMap[SequenceSingle->Element].FindByPredicate([&](const FEventNameToNextNode& E){ return E.NodeId == PendingActivatedIds[Idx + 1]; });
-			FLocal{ *this }.FinishSequence(SequenceSingle, EventName->EventName);
+			FLocal{ *this }.FinishSequence(SequenceSingle, Graph.GetEventName(SequenceSingle->Element, PendingActivatedIds[Idx + 1]));
 		}
 		else if (const FGameQuestSequenceList* SequenceList = GameQuestCast<FGameQuestSequenceList>(Sequence))
 		{
@@ -844,15 +1780,11 @@ void UGameQuestGraphBase::ForceActivateSequenceToServer_Implementation(const uin
 			Idx += 1;
 			const uint16 ElementId = PendingActivatedIds[Idx];
 			FGameQuestElementBase* BranchElement = GetElementPtr(ElementId);
-			using FEventNameToNextNode = UGameQuestGraphGeneratedClass::FEventNameNodeId;
-			const FEventNameToNextNode* EventName = Class->NodeIdEventNameMap[ElementId].FindByPredicate([&](const FEventNameToNextNode& E){ return E.NodeId == PendingActivatedIds[Idx + 1]; });
-			BranchElement->ForceFinishElement(EventName->EventName);
+			BranchElement->ForceFinishElement(Graph.GetEventName(ElementId, PendingActivatedIds[Idx + 1]));
 		}
 		else if (const FGameQuestSequenceSubQuest* SequenceSubQuest = GameQuestCast<FGameQuestSequenceSubQuest>(Sequence))
 		{
-			using FEventNameToNextNode = UGameQuestGraphGeneratedClass::FEventNameNodeId;
-			const FEventNameToNextNode* RerouteTagName = Class->NodeIdEventNameMap[PendingActivatedIds[Idx]].FindByPredicate([&](const FEventNameToNextNode& E){ return E.NodeId == PendingActivatedIds[Idx + 1]; });
-			FLocal{ *this }.FinishSequence(SequenceSubQuest, RerouteTagName->EventName);
+			FLocal{ *this }.FinishSequence(SequenceSubQuest, Graph.GetEventName(PendingActivatedIds[Idx], PendingActivatedIds[Idx + 1]));
 		}
 		else
 		{
@@ -917,8 +1849,6 @@ DEFINE_FUNCTION(UGameQuestGraphBase::execCallNodeRepFunction)
 	P_NATIVE_END;
 }
 
-TArray<Context::FAddNextSequenceIdFunc> StartCachedAddNextSequenceIdFuncList;
-
 bool UGameQuestGraphBase::TryStartGameQuest()
 {
 	if (GetQuestState() != EState::Unactivated)
@@ -930,12 +1860,9 @@ bool UGameQuestGraphBase::TryStartGameQuest()
 	UE_LOG(LogGameQuest, Verbose, TEXT("StartGameQuest %s"), *GetName());
 	bIsActivated = true;
 
-	StartCachedAddNextSequenceIdFuncList.Push(MoveTemp(Context::AddNextSequenceIdFunc));
-	Context::AddNextSequenceIdFunc = [this](const uint16 SequenceId)
-	{
-		StartSequences.Add(SequenceId);
-		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, StartSequences, this);
-	};
+	FGameQuestExecutionContext& Context = GetExecutionContext();
+	Context.StartCachedSuccessorSinks.Push(Context.SuccessorSink);
+	Context.SuccessorSink = FGameQuestSuccessorSink{ StartSequences, *this };
 
 	if (UGameQuestComponent* OwnerComp = Cast<UGameQuestComponent>(Owner))
 	{
@@ -956,12 +1883,14 @@ void UGameQuestGraphBase::PostExecuteEntryEvent()
 		}
 		Sequence->ActivateSequence(SequenceId);
 	}
-	Context::AddNextSequenceIdFunc = StartCachedAddNextSequenceIdFuncList.Pop();
+	FGameQuestExecutionContext& Context = GetExecutionContext();
+	Context.SuccessorSink = Context.StartCachedSuccessorSinks.Pop();
 }
 
 void UGameQuestGraphBase::ProcessRerouteTag(FName RerouteTagName, FGameQuestRerouteTag& RerouteTag)
 {
-	const uint16 FinishedSequenceId = Context::CurrentFinishedSequenceId;
+	const FGameQuestExecutionContext& Context = GetExecutionContext();
+	const uint16 FinishedSequenceId = Context.CurrentFinishedSequenceId;
 	if (!ensure(FinishedSequenceId != GameQuest::IdNone))
 	{
 		return;
@@ -971,7 +1900,8 @@ void UGameQuestGraphBase::ProcessRerouteTag(FName RerouteTagName, FGameQuestRero
 		return;
 	}
 	RerouteTag.PreSequenceId = FinishedSequenceId;
-	RerouteTag.PreBranchId = Context::CurrentFinishedBranchId;
+	RerouteTag.PreBranchId = Context.CurrentFinishedBranchId;
+	MarkSaveStateDirty();
 	if (OwnerNode == nullptr)
 	{
 		return;
@@ -1011,6 +1941,8 @@ void UGameQuestGraphBase::InvokeInterruptQuest()
 	bIsActivated = false;
 	bInterrupted = true;
 	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, bInterrupted, this);
+	MarkCompactStateDirty();
+	MarkSaveStateDirty();
 
 	UE_LOG(LogGameQuest, Verbose, TEXT("InterruptQuest %s"), *GetName());
 	if (UGameQuestComponent* OwnerComp = Cast<UGameQuestComponent>(Owner))
@@ -3,8 +3,11 @@
 
 #include "GameQuestGraphBlueprint.h"
 
+#include "GameQuestElementBase.h"
 #include "GameQuestGraphBase.h"
 #include "GameQuestNodeBase.h"
+#include "GameQuestSequenceBase.h"
+#include "GameQuestStateSerializer.h"
 
 #if WITH_EDITOR
 UClass* UGameQuestGraphBlueprint::GetBlueprintClass() const
@@ -34,11 +37,17 @@ void UGameQuestGraphGeneratedClass::PostQuestCDOInitProperties()
 {
 	NodeIdPropertyMap.Empty();
 	RerouteTags.Empty();
+	NodeInitDescs.Reset();
+	const UObject* DefaultObject = GetDefaultObject(false);
+	check(DefaultObject);
 	for (TFieldIterator<FStructProperty> It{ this }; It; ++It)
 	{
 		if (It->Struct->IsChildOf(FGameQuestNodeBase::StaticStruct()))
 		{
 			const uint16* NodeIndex = NodeNameIdMap.Find(It->GetFName());
+			FGameQuestNodeInitDesc& InitDesc = NodeInitDescs.Emplace_GetRef(this, *It, *It->ContainerPtrToValuePtr<FGameQuestNodeBase>(DefaultObject));
+			InitDesc.NodeId = NodeIndex ? *NodeIndex : GameQuest::IdNone;
+			InitDesc.LogicList = NodeIdLogicsMap.Find(InitDesc.NodeId);
 			if (NodeIndex == nullptr)
 			{
 				continue;
@@ -54,6 +63,29 @@ void UGameQuestGraphGeneratedClass::PostQuestCDOInitProperties()
 			}
 		}
 	}
+	NodeTable.Reset();
+	for (const auto& [NodeId, Property] : NodeIdPropertyMap)
+	{
+		if (NodeTable.Num() <= NodeId)
+		{
+			NodeTable.SetNum(NodeId + 1);
+		}
+		FNodeEntry& Entry = NodeTable[NodeId];
+		Entry.Offset = Property->GetOffset_ForInternal();
+		if (Property->Struct->IsChildOf(FGameQuestSequenceBase::StaticStruct()))
+		{
+			Entry.Kind = ENodeKind::Sequence;
+		}
+		else if (Property->Struct->IsChildOf(FGameQuestElementBase::StaticStruct()))
+		{
+			Entry.Kind = ENodeKind::Element;
+		}
+	}
+	bRuntimeTablesBuilt = false;
+	{
+		FScopeLock Lock(&SuccessorGraphLock);
+		SuccessorGraph.Reset();
+	}
 	NodeToPredecessorMap.Empty();
 	for (const auto& [FromNode, ToNodes] : NodeToSuccessorMap)
 	{
@@ -63,3 +95,249 @@ void UGameQuestGraphGeneratedClass::PostQuestCDOInitProperties()
 		}
 	}
 }
+
+void UGameQuestGraphGeneratedClass::ConditionalBuildRuntimeTables(const UGameQuestGraphBase& Quest)
+{
+	if (bRuntimeTablesBuilt)
+	{
+		return;
+	}
+	// Only contended by the instances created before the tables built
+	FScopeLock Lock(&RuntimeTablesLock);
+	if (bRuntimeTablesBuilt)
+	{
+		return;
+	}
+	BuildListLogicMasks(Quest);
+	BuildBranchElementRoles(Quest);
+	BuildCompactStateLayout(Quest);
+	BuildSaveStateLayout(Quest);
+	bRuntimeTablesBuilt = true;
+}
+
+void UGameQuestGraphGeneratedClass::BuildListLogicMasks(const UGameQuestGraphBase& Quest)
+{
+	ListLogicMasks.Reset();
+	NodeIdListSlots.Init(INDEX_NONE, NodeTable.Num());
+	ElementListBits.Init({}, NodeTable.Num());
+	for (const auto& [ListId, Logics] : NodeIdLogicsMap)
+	{
+		if (NodeTable.IsValidIndex(ListId) == false)
+		{
+			continue;
+		}
+		const TArray<uint16>* Elements = nullptr;
+		if (NodeTable[ListId].Kind == ENodeKind::Sequence)
+		{
+			const FGameQuestSequenceBase* Sequence = Quest.GetSequencePtr(ListId);
+			if (const FGameQuestSequenceList* SequenceList = GameQuestCast<FGameQuestSequenceList>(Sequence))
+			{
+				Elements = &SequenceList->Elements;
+			}
+			else if (const FGameQuestSequenceBranch* SequenceBranch = GameQuestCast<FGameQuestSequenceBranch>(Sequence))
+			{
+				Elements = &SequenceBranch->Elements;
+			}
+		}
+		else if (const FGameQuestElementBranchList* BranchList = GameQuestCast<FGameQuestElementBranchList>(Quest.GetElementPtr(ListId)))
+		{
+			Elements = &BranchList->Elements;
+		}
+		if (Elements == nullptr || Elements->Num() == 0 || Elements->Num() > 64 || Elements->Num() != Logics.Num() + 1)
+		{
+			continue;
+		}
+		const int32 Slot = ListLogicMasks.AddDefaulted();
+		NodeIdListSlots[ListId] = Slot;
+		FListLogicMask& ListLogicMask = ListLogicMasks[Slot];
+		uint64 GroupMask = 0;
+		for (int32 Idx = 0; Idx < Elements->Num(); ++Idx)
+		{
+			if (Idx > 0 && Logics[Idx - 1] == EGameQuestSequenceLogic::Or)
+			{
+				ListLogicMask.GroupMasks.Add(GroupMask);
+				GroupMask = 0;
+			}
+			const uint16 ElementId = (*Elements)[Idx];
+			ElementListBits[ElementId] = { Slot, static_cast<uint8>(Idx) };
+			if (Quest.GetElementPtr(ElementId)->bIsOptional == false)
+			{
+				GroupMask |= uint64(1) << Idx;
+			}
+		}
+		ListLogicMask.GroupMasks.Add(GroupMask);
+	}
+}
+
+void UGameQuestGraphGeneratedClass::BuildBranchElementRoles(const UGameQuestGraphBase& Quest)
+{
+	using namespace GameQuest;
+	BranchElementRoles.Init({}, NodeTable.Num());
+	for (int32 SequenceId = 0; SequenceId < NodeTable.Num(); ++SequenceId)
+	{
+		if (NodeTable[SequenceId].Kind != ENodeKind::Sequence)
+		{
+			continue;
+		}
+		const FGameQuestSequenceBranch* SequenceBranch = GameQuestCast<FGameQuestSequenceBranch>(Quest.GetSequencePtr(SequenceId));
+		if (SequenceBranch == nullptr)
+		{
+			continue;
+		}
+		for (const uint16 ElementId : SequenceBranch->Elements)
+		{
+			BranchElementRoles[ElementId].Role = EBranchElementRole::Precondition;
+		}
+		for (int32 BranchIndex = 0; BranchIndex < SequenceBranch->Branches.Num(); ++BranchIndex)
+		{
+			const uint16 BranchElementId = SequenceBranch->Branches[BranchIndex].Element;
+			BranchElementRoles[BranchElementId] = { EBranchElementRole::Branch, static_cast<int16>(BranchIndex) };
+			if (const FGameQuestElementBranchList* BranchList = GameQuestCast<FGameQuestElementBranchList>(Quest.GetElementPtr(BranchElementId)))
+			{
+				for (const uint16 ElementId : BranchList->Elements)
+				{
+					BranchElementRoles[ElementId] = { EBranchElementRole::BranchListMember, static_cast<int16>(BranchIndex) };
+				}
+			}
+		}
+	}
+}
+
+void UGameQuestGraphGeneratedClass::BuildCompactStateLayout(const UGameQuestGraphBase& Quest)
+{
+	using ESequenceKind = FCompactStateLayout::ESequenceKind;
+	CompactStateLayout = FCompactStateLayout{};
+	FCompactStateLayout& Layout = CompactStateLayout;
+	// Quest interrupted flag and start sequences slot
+	Layout.FlagNum = 1;
+	Layout.SlotNum = 1;
+	for (int32 NodeId = 0; NodeId < NodeTable.Num(); ++NodeId)
+	{
+		if (NodeTable[NodeId].Kind == ENodeKind::Element)
+		{
+			Layout.Elements.Add(NodeId);
+			Layout.FlagNum += 1;
+			continue;
+		}
+		if (NodeTable[NodeId].Kind != ENodeKind::Sequence)
+		{
+			continue;
+		}
+		// Interrupted and activated flag, pre sequence slot
+		FCompactStateLayout::FSequence& Entry = Layout.Sequences.Add_GetRef({ static_cast<uint16>(NodeId) });
+		Layout.FlagNum += 2;
+		Layout.SlotNum += 1;
+		const FGameQuestSequenceBase* Sequence = Quest.GetSequencePtr(NodeId);
+		if (GameQuestCast<FGameQuestSequenceSingle>(Sequence))
+		{
+			Entry.Kind = ESequenceKind::Single;
+			Layout.SlotNum += 1;
+		}
+		else if (GameQuestCast<FGameQuestSequenceList>(Sequence))
+		{
+			Entry.Kind = ESequenceKind::List;
+			Layout.SlotNum += 1;
+		}
+		else if (const FGameQuestSequenceBranch* SequenceBranch = GameQuestCast<FGameQuestSequenceBranch>(Sequence))
+		{
+			Entry.Kind = ESequenceKind::Branch;
+			Entry.BranchNum = SequenceBranch->Branches.Num();
+			Layout.FlagNum += 1;
+			Layout.SlotNum += Entry.BranchNum;
+		}
+	}
+}
+
+void UGameQuestGraphGeneratedClass::BuildSaveStateLayout(const UGameQuestGraphBase& Quest)
+{
+	SaveStateLayout = FSaveStateLayout{};
+	FSaveStateLayout& Layout = SaveStateLayout;
+	FGameQuestStateSerializer::GetExtraSaveProperties(this, Layout.ExtraProperties);
+	Layout.ExtraStateNodes.Init(false, NodeTable.Num());
+	TArray<const FProperty*> ExtraProperties;
+	for (const auto& [NodeId, Property] : NodeIdPropertyMap)
+	{
+		ExtraProperties.Reset();
+		FGameQuestStateSerializer::GetExtraSaveProperties(Property->Struct, ExtraProperties);
+		bool bHasExtraState = ExtraProperties.Num() > 0;
+		const FGameQuestElementScript* ElementScript = GameQuestCast<FGameQuestElementScript>(Property->ContainerPtrToValuePtr<FGameQuestNodeBase>(&Quest));
+		if (bHasExtraState == false && ElementScript && ElementScript->Instance)
+		{
+			FGameQuestStateSerializer::GetExtraSaveProperties(ElementScript->Instance->GetClass(), ExtraProperties);
+			bHasExtraState = ExtraProperties.Num() > 0;
+		}
+		Layout.ExtraStateNodes[NodeId] = bHasExtraState;
+	}
+}
+
+const UGameQuestGraphGeneratedClass::FSuccessorGraph& UGameQuestGraphGeneratedClass::GetSuccessorGraph() const
+{
+	FScopeLock Lock(&SuccessorGraphLock);
+	if (SuccessorGraph)
+	{
+		return *SuccessorGraph;
+	}
+	TUniquePtr<FSuccessorGraph> NewGraph = MakeUnique<FSuccessorGraph>();
+	FSuccessorGraph& Graph = *NewGraph;
+	const int32 NodeNum = NodeTable.Num();
+	Graph.NodeNum = NodeNum;
+	Graph.Offsets.SetNumZeroed(NodeNum + 1);
+	for (const auto& [FromNode, ToNodes] : NodeToSuccessorMap)
+	{
+		if (FromNode < NodeNum)
+		{
+			Graph.Offsets[FromNode + 1] = ToNodes.Num();
+		}
+	}
+	for (int32 Idx = 0; Idx < NodeNum; ++Idx)
+	{
+		Graph.Offsets[Idx + 1] += Graph.Offsets[Idx];
+	}
+	Graph.Successors.SetNumUninitialized(Graph.Offsets[NodeNum]);
+	for (const auto& [FromNode, ToNodes] : NodeToSuccessorMap)
+	{
+		if (FromNode < NodeNum && ToNodes.Num() > 0)
+		{
+			FMemory::Memcpy(&Graph.Successors[Graph.Offsets[FromNode]], ToNodes.GetData(), ToNodes.Num() * sizeof(uint16));
+		}
+	}
+
+	Graph.NextHops.Init(GameQuest::IdNone, NodeNum * NodeNum);
+	Graph.Distances.Init(FSuccessorGraph::Unreachable, NodeNum * NodeNum);
+	TArray<uint16> Queue;
+	Queue.Reserve(NodeNum);
+	for (int32 From = 0; From < NodeNum; ++From)
+	{
+		uint16* NextHopRow = &Graph.NextHops[From * NodeNum];
+		uint16* DistanceRow = &Graph.Distances[From * NodeNum];
+		DistanceRow[From] = 0;
+		Queue.Reset();
+		Queue.Add(From);
+		for (int32 Head = 0; Head < Queue.Num(); ++Head)
+		{
+			const uint16 NodeId = Queue[Head];
+			for (int32 EdgeIdx = Graph.Offsets[NodeId]; EdgeIdx < Graph.Offsets[NodeId + 1]; ++EdgeIdx)
+			{
+				const uint16 ToId = Graph.Successors[EdgeIdx];
+				if (ToId >= NodeNum || DistanceRow[ToId] != FSuccessorGraph::Unreachable)
+				{
+					continue;
+				}
+				DistanceRow[ToId] = DistanceRow[NodeId] + 1;
+				NextHopRow[ToId] = NodeId == From ? ToId : NextHopRow[NodeId];
+				Queue.Add(ToId);
+			}
+		}
+	}
+
+	for (const auto& [EventNodeId, EventNames] : NodeIdEventNameMap)
+	{
+		for (const FEventNameNodeId& EventName : EventNames)
+		{
+			Graph.EdgeEventNames.FindOrAdd(uint32(EventNodeId) << 16 | EventName.NodeId, EventName.EventName);
+		}
+	}
+	// Only published when complete, never changed after
+	SuccessorGraph = MoveTemp(NewGraph);
+	return *SuccessorGraph;
+}
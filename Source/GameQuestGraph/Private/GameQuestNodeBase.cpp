@@ -6,6 +6,27 @@
 #include "GameQuestGraphBase.h"
 #include "Net/NetPushModelHelpers.h"
 
+FGameQuestNodeInitDesc::FGameQuestNodeInitDesc(const UClass* QuestClass, FStructProperty* InProperty, const FGameQuestNodeBase& TemplateNode)
+	: Property(InProperty)
+	, Offset(InProperty->GetOffset_ForInternal())
+{
+	EvaluateParamsFunction = QuestClass->FindFunctionByName(FGameQuestNodeBase::MakeEvaluateParamsFunctionName(InProperty->GetFName()));
+	TemplateNode.BuildQuestInitDesc(*this, QuestClass);
+}
+
+FGameQuestNodeInitDesc::FEventBinding FGameQuestNodeInitDesc::MakeEventBinding(const void* Owner, const TObjectPtr<UFunction>& Slot, UFunction* Event)
+{
+	return { static_cast<int32>(reinterpret_cast<const uint8*>(&Slot) - static_cast<const uint8*>(Owner)), Event };
+}
+
+void FGameQuestNodeInitDesc::ApplyEventBindings(void* Owner, TConstArrayView<FEventBinding> Bindings)
+{
+	for (const FEventBinding& Binding : Bindings)
+	{
+		*reinterpret_cast<TObjectPtr<UFunction>*>(static_cast<uint8*>(Owner) + Binding.Offset) = Binding.Event;
+	}
+}
+
 void FGameQuestNodeBase::GetEvaluateGraphExposedInputs() const
 {
 	GetEvaluateGraphExposedInputs(OwnerQuest->HasAuthority());
@@ -27,4 +48,6 @@ void FGameQuestNodeBase::MarkNodeNetDirty() const
 		return;
 	}
 	UNetPushModelHelpers::MarkPropertyDirtyFromRepIndex(OwnerQuest, NodeProperty->RepIndex, NodeProperty->GetFName());
+	OwnerQuest->MarkCompactStateDirty();
+	OwnerQuest->MarkNodeSaveStateDirty(NodeId);
 }
@@ -5,19 +5,12 @@
 
 #include "GameQuestElementBase.h"
 #include "GameQuestGraphBase.h"
+#include "GameQuestGraphBlueprint.h"
+#include "GameQuestTickManager.h"
 #include "Engine/ActorChannel.h"
 #include "Engine/AssetManager.h"
 #include "Net/Core/PushModel/PushModel.h"
 
-namespace Context
-{
-	// For finish quest element context
-	uint16 CurrentFinishedSequenceId;
-	uint16 CurrentFinishedBranchId;
-	FAddNextSequenceIdFunc AddNextSequenceIdFunc;
-	FName PreRerouteTagName;
-}
-
 void FGameQuestSequenceBase::TryActivateSequence()
 {
 	check(OwnerQuest);
@@ -27,18 +20,19 @@ void FGameQuestSequenceBase::TryActivateSequence()
 		return;
 	}
 
-	using namespace Context;
+	FGameQuestExecutionContext& Context = OwnerQuest->GetExecutionContext();
 	const uint16 SequenceId = OwnerQuest->GetSequenceId(this);
 
 	if (GetSequenceState() != EState::Deactivated)
 	{
-		AddNextSequenceIdFunc(SequenceId);
+		Context.SuccessorSink.Add(SequenceId);
 	}
-	else if (CurrentFinishedSequenceId != GameQuest::IdNone)
+	else if (Context.CurrentFinishedSequenceId != GameQuest::IdNone)
 	{
-		PreSequence = CurrentFinishedSequenceId;
+		PreSequence = Context.CurrentFinishedSequenceId;
 	}
-	AddNextSequenceIdFunc(SequenceId);
+	Context.SuccessorSink.Add(SequenceId);
+	RefreshSequenceState();
 }
 
 void FGameQuestSequenceBase::ActivateSequence(uint16 SequenceId)
@@ -67,25 +61,26 @@ void FGameQuestSequenceBase::ActivateSequenceImpl(uint16 SequenceId)
 	check(bIsActivated == false);
 	check(bInterrupted == false);
 	bIsActivated = true;
+	State = EState::Activated;
 	if constexpr (bHasAuthority)
 	{
 		UE_LOG(LogGameQuest, Verbose, TEXT("ActivateSequence %s.%s"), *OwnerQuest->GetName(), *GetNodeName().ToString());
-		check(OwnerQuest->ActivatedSequences.Contains(SequenceId) == false);
+		check(OwnerQuest->IsSequenceIdActivated(SequenceId) == false);
 		OwnerQuest->ActivatedSequences.Add(SequenceId);
+		UGameQuestGraphBase::SetActivatedBit(OwnerQuest->ActivatedSequenceBits, SequenceId, true);
 		MARK_PROPERTY_DIRTY_FROM_NAME(UGameQuestGraphBase, ActivatedSequences, OwnerQuest);
+		OwnerQuest->MarkCompactStateDirty();
+		OwnerQuest->MarkSaveStateDirty();
 		if (ShouldReplicatedSubobject())
 		{
-			OwnerQuest->ReplicateSubobjectNodes.Add(this);
+			OwnerQuest->AddReplicateSubobjectNode(this);
 		}
 	}
 	else
 	{
 		UE_LOG(LogGameQuest, Verbose, TEXT("OnRepActivateSequence %s.%s"), *OwnerQuest->GetName(), *GetNodeName().ToString());
 	}
-	if (IsTickable())
-	{
-		OwnerQuest->TickableSequences.Add(this);
-	}
+	RegisterTick();
 	GetEvaluateGraphExposedInputs(bHasAuthority);
 	OwnerQuest->PreSequenceActivated(this, SequenceId);
 	WhenSequenceActivated(bHasAuthority);
@@ -98,14 +93,15 @@ void FGameQuestSequenceBase::DeactivateSequenceImpl(uint16 SequenceId)
 	bIsActivated = false;
 	if constexpr (bHasAuthority)
 	{
-		check(OwnerQuest->ActivatedSequences.Contains(SequenceId));
-		OwnerQuest->ActivatedSequences.Remove(SequenceId);
+		check(OwnerQuest->IsSequenceIdActivated(SequenceId));
+		OwnerQuest->ActivatedSequences.RemoveSingle(SequenceId);
+		UGameQuestGraphBase::SetActivatedBit(OwnerQuest->ActivatedSequenceBits, SequenceId, false);
 		MARK_PROPERTY_DIRTY_FROM_NAME(UGameQuestGraphBase, ActivatedSequences, OwnerQuest);
+		OwnerQuest->MarkCompactStateDirty();
+		OwnerQuest->MarkSaveStateDirty();
 	}
-	if (IsTickable())
-	{
-		OwnerQuest->TickableSequences.Remove(this);
-	}
+	RefreshSequenceState();
+	UnregisterTick();
 	WhenSequenceDeactivated(bHasAuthority);
 	OwnerQuest->PostSequenceDeactivated(this, SequenceId);
 	if constexpr (bHasAuthority)
@@ -118,6 +114,28 @@ void FGameQuestSequenceBase::DeactivateSequenceImpl(uint16 SequenceId)
 	}
 }
 
+void FGameQuestSequenceBase::RegisterTick()
+{
+	if (IsTickable())
+	{
+		if (UGameQuestTickManager* TickManager = UGameQuestTickManager::Get(OwnerQuest))
+		{
+			TickManager->RegisterSequence(*this);
+		}
+	}
+}
+
+void FGameQuestSequenceBase::UnregisterTick()
+{
+	if (TickIndex != INDEX_NONE)
+	{
+		if (UGameQuestTickManager* TickManager = UGameQuestTickManager::Get(OwnerQuest))
+		{
+			TickManager->UnregisterSequence(*this);
+		}
+	}
+}
+
 void FGameQuestSequenceBase::InterruptSequence()
 {
 	if (!ensure(bInterrupted == false))
@@ -125,6 +143,7 @@ void FGameQuestSequenceBase::InterruptSequence()
 		return;
 	}
 	bInterrupted = true;
+	RefreshSequenceState();
 	MarkNodeNetDirty();
 	if (bIsActivated)
 	{
@@ -133,7 +152,13 @@ void FGameQuestSequenceBase::InterruptSequence()
 	}
 }
 
-FGameQuestSequenceBase::EState FGameQuestSequenceBase::GetSequenceState() const
+void FGameQuestSequenceBase::WhenOnRepValue(const FGameQuestNodeBase& PreValue)
+{
+	Super::WhenOnRepValue(PreValue);
+	RefreshSequenceState();
+}
+
+FGameQuestSequenceBase::EState FGameQuestSequenceBase::EvaluateSequenceState() const
 {
 	if (bIsActivated)
 	{
@@ -145,12 +170,12 @@ FGameQuestSequenceBase::EState FGameQuestSequenceBase::GetSequenceState() const
 	}
 	if (PreSequence == GameQuest::IdNone)
 	{
-		const uint16 SequenceId = OwnerQuest->GetSequenceId(this);
+		const uint16 SequenceId = GetNodeId();
 		if (OwnerQuest->StartSequences.Contains(SequenceId) == false)
 		{
 			return EState::Deactivated;
 		}
-		if (OwnerQuest->ActivatedSequences.Contains(SequenceId))
+		if (OwnerQuest->IsSequenceIdActivated(SequenceId))
 		{
 			return EState::Deactivated;
 		}
@@ -160,15 +185,8 @@ FGameQuestSequenceBase::EState FGameQuestSequenceBase::GetSequenceState() const
 
 void FGameQuestSequenceBase::ExecuteFinishEvent(UFunction* FinishEvent, const TArray<uint16>& NextSequenceIds, uint16 BranchId) const
 {
-	using namespace Context;
-
-	struct FLastFinished
-	{
-		UGameQuestGraphBase* Quest = nullptr;
-		uint16 SequenceId = GameQuest::IdNone;
-		uint16 BranchId = GameQuest::IdNone;
-	};
-	static TArray<FLastFinished, TInlineAllocator<2>> LastFinishedStack;
+	FGameQuestExecutionContext& Context = OwnerQuest->GetExecutionContext();
+	auto& LastFinishedStack = Context.LastFinishedStack;
 
 	const uint16 SequenceId = OwnerQuest->GetSequenceId(this);
 	const bool bIsFirstEntryQuest = LastFinishedStack.Num() == 0 || LastFinishedStack.Last().Quest != OwnerQuest;
@@ -186,7 +204,7 @@ void FGameQuestSequenceBase::ExecuteFinishEvent(UFunction* FinishEvent, const TA
 	bool bNextHasInterrupted = false;
 	if (FinishEvent)
 	{
-		TGuardValue FinishedSequenceGuard{ CurrentFinishedSequenceId, SequenceId };
+		TGuardValue FinishedSequenceGuard{ Context.CurrentFinishedSequenceId, SequenceId };
 
 		OwnerQuest->ProcessEvent(FinishEvent, nullptr);
 
@@ -206,11 +224,11 @@ void FGameQuestSequenceBase::ExecuteFinishEvent(UFunction* FinishEvent, const TA
 	}
 	if (bIsFirstEntryQuest)
 	{
-		const FLastFinished LastFinished = LastFinishedStack.Pop();
+		const FGameQuestExecutionContext::FLastFinished LastFinished = LastFinishedStack.Pop();
 		if (bNextSequenceActivated == false)
 		{
-			TGuardValue FinishedSequenceGuard{ CurrentFinishedSequenceId, LastFinished.SequenceId };
-			TGuardValue FinishedBranchGuard{ CurrentFinishedBranchId, LastFinished.BranchId };
+			TGuardValue FinishedSequenceGuard{ Context.CurrentFinishedSequenceId, LastFinished.SequenceId };
+			TGuardValue FinishedBranchGuard{ Context.CurrentFinishedBranchId, LastFinished.BranchId };
 			if (bNextHasInterrupted)
 			{
 				OwnerQuest->InvokeInterruptQuest();
@@ -223,12 +241,18 @@ void FGameQuestSequenceBase::ExecuteFinishEvent(UFunction* FinishEvent, const TA
 	}
 }
 
-bool FGameQuestSequenceBase::CanFinishListElements(const TArray<uint16>& Elements, const GameQuest::FLogicList& ElementLogics) const
+bool FGameQuestSequenceBase::CanFinishListElements(const FGameQuestNodeBase& ListNode, const TArray<uint16>& Elements) const
 {
 	if (ensure(Elements.Num() != 0) == false)
 	{
 		return true;
 	}
+	bool bCanFinish;
+	if (OwnerQuest->CanFinishListByMask(ListNode.GetNodeId(), bCanFinish))
+	{
+		return bCanFinish;
+	}
+	const GameQuest::FLogicList& ElementLogics = OwnerQuest->GetLogicList(&ListNode);
 	const FGameQuestElementBase* FirstElement = OwnerQuest->GetElementPtr(Elements[0]);
 	bool CheckFlag = FirstElement->bIsOptional ? true : FirstElement->bIsFinished;
 	if (Elements.Num() == 1)
@@ -274,18 +298,15 @@ void FGameQuestSequenceSingle::WhenSequenceDeactivated(bool bHasAuthority)
 void FGameQuestSequenceSingle::WhenElementFinished(FGameQuestElementBase* FinishedElement, const FGameQuestFinishEvent& OnElementFinishedEvent)
 {
 	DeactivateSequence(OwnerQuest->GetSequenceId(this));
-	TGuardValue<Context::FAddNextSequenceIdFunc> AddNextSequenceIdFuncGuard{ Context::AddNextSequenceIdFunc, [this](const uint16 SequenceId)
-	{
-		NextSequences.Add(SequenceId);
-		MarkNodeNetDirty();
-	}};
+	TGuardValue SuccessorSinkGuard{ OwnerQuest->GetExecutionContext().SuccessorSink, FGameQuestSuccessorSink{ NextSequences, *this } };
 	ExecuteFinishEvent(OnElementFinishedEvent.Event, NextSequences, 0);
 }
 
-void FGameQuestSequenceList::WhenQuestInitProperties(const FStructProperty* Property)
+void FGameQuestSequenceList::BuildQuestInitDesc(FGameQuestNodeInitDesc& Desc, const UClass* QuestClass) const
 {
-	const UClass* QuestClass = OwnerQuest->GetClass();
-	OnSequenceFinished = QuestClass->FindFunctionByName(FGameQuestFinishEvent::MakeEventName(Property->GetFName(), GET_MEMBER_NAME_CHECKED(FGameQuestSequenceList, OnSequenceFinished)));
+	Super::BuildQuestInitDesc(Desc, QuestClass);
+	UFunction* Event = QuestClass->FindFunctionByName(FGameQuestFinishEvent::MakeEventName(Desc.Property->GetFName(), GET_MEMBER_NAME_CHECKED(FGameQuestSequenceList, OnSequenceFinished)));
+	Desc.EventBindings.Add(FGameQuestNodeInitDesc::MakeEventBinding(this, OnSequenceFinished, Event));
 }
 
 void FGameQuestSequenceList::WhenSequenceActivated(bool bHasAuthority)
@@ -316,14 +337,10 @@ void FGameQuestSequenceList::WhenSequenceDeactivated(bool bHasAuthority)
 
 void FGameQuestSequenceList::WhenElementFinished(FGameQuestElementBase* FinishedElement, const FGameQuestFinishEvent& OnElementFinishedEvent)
 {
-	if (CanFinishListElements(Elements, OwnerQuest->GetLogicList(this)))
+	if (CanFinishListElements(*this, Elements))
 	{
 		DeactivateSequence(OwnerQuest->GetSequenceId(this));
-		TGuardValue<Context::FAddNextSequenceIdFunc> AddNextSequenceIdFuncGuard{ Context::AddNextSequenceIdFunc, [this](const uint16 SequenceId)
-		{
-			NextSequences.Add(SequenceId);
-			MarkNodeNetDirty();
-		}};
+		TGuardValue SuccessorSinkGuard{ OwnerQuest->GetExecutionContext().SuccessorSink, FGameQuestSuccessorSink{ NextSequences, *this } };
 		ExecuteFinishEvent(OnSequenceFinished, NextSequences, 0);
 	}
 }
@@ -384,21 +401,20 @@ void FGameQuestSequenceBranch::WhenSequenceDeactivated(bool bHasAuthority)
 
 void FGameQuestSequenceBranch::WhenElementFinished(FGameQuestElementBase* FinishedElement, const FGameQuestFinishEvent& OnElementFinishedEvent)
 {
+	using namespace GameQuest;
 	const uint16 FinishedElementId = OwnerQuest->GetElementId(FinishedElement);
-	if (Elements.Contains(FinishedElementId))
+	const FBranchElementRole ElementRole = GetElementRole(FinishedElementId);
+	if (ElementRole.Role == EBranchElementRole::Precondition)
 	{
 		if (bIsBranchesActivated == false && CanActivateBranchElement())
 		{
 			ActivateBranches(true);
 		}
 	}
-	else if (FGameQuestSequenceBranchElement* Branch = Branches.FindByPredicate([&](const FGameQuestSequenceBranchElement& E) { return E.Element == FinishedElementId; }))
+	else if (ElementRole.Role == EBranchElementRole::Branch)
 	{
-		TGuardValue<Context::FAddNextSequenceIdFunc> AddNextSequenceIdFuncGuard{ Context::AddNextSequenceIdFunc, [this, Branch](const uint16 SequenceId)
-		{
-			Branch->NextSequences.Add(SequenceId);
-			MarkNodeNetDirty();
-		}};
+		FGameQuestSequenceBranchElement* Branch = &Branches[ElementRole.BranchIndex];
+		TGuardValue SuccessorSinkGuard{ OwnerQuest->GetExecutionContext().SuccessorSink, FGameQuestSuccessorSink{ Branch->NextSequences, *this } };
 		if (Branch->bAutoDeactivateOtherBranch)
 		{
 			DeactivateSequence(OwnerQuest->GetSequenceId(this));
@@ -428,18 +444,10 @@ void FGameQuestSequenceBranch::WhenElementFinished(FGameQuestElementBase* Finish
 			}
 		}
 	}
-	else if (const FGameQuestSequenceBranchElement* ListBranch = Branches.FindByPredicate([&](const FGameQuestSequenceBranchElement& E)
-		{
-			const FGameQuestElementBase* Element = OwnerQuest->GetElementPtr(E.Element);
-			if (const FGameQuestElementBranchList* BranchList = GameQuestCast<FGameQuestElementBranchList>(Element))
-			{
-				return BranchList->Elements.Contains(FinishedElementId);
-			}
-			return false;
-		}))
+	else if (ElementRole.Role == EBranchElementRole::BranchListMember)
 	{
-		FGameQuestElementBranchList* BranchList = GameQuestCastChecked<FGameQuestElementBranchList>(OwnerQuest->GetElementPtr(ListBranch->Element));
-		if (CanFinishListElements(BranchList->Elements, OwnerQuest->GetLogicList(BranchList)))
+		FGameQuestElementBranchList* BranchList = GameQuestCastChecked<FGameQuestElementBranchList>(OwnerQuest->GetElementPtr(Branches[ElementRole.BranchIndex].Element));
+		if (CanFinishListElements(*BranchList, BranchList->Elements))
 		{
 			BranchList->FinishElement(BranchList->OnListFinished, GET_MEMBER_NAME_CHECKED(FGameQuestElementBranchList, OnListFinished));
 		}
@@ -458,13 +466,47 @@ void FGameQuestSequenceBranch::WhenElementUnfinished(FGameQuestElementBase* Fini
 	}
 }
 
+GameQuest::FBranchElementRole FGameQuestSequenceBranch::GetElementRole(uint16 ElementId) const
+{
+	using namespace GameQuest;
+	const UGameQuestGraphGeneratedClass* Class = Cast<UGameQuestGraphGeneratedClass>(OwnerQuest->GetClass());
+	if (Class && Class->IsRuntimeTablesBuilt())
+	{
+		return Class->BranchElementRoles.IsValidIndex(ElementId) ? Class->BranchElementRoles[ElementId] : FBranchElementRole{};
+	}
+	if (Elements.Contains(ElementId))
+	{
+		return { EBranchElementRole::Precondition };
+	}
+	for (int32 BranchIndex = 0; BranchIndex < Branches.Num(); ++BranchIndex)
+	{
+		const uint16 BranchElementId = Branches[BranchIndex].Element;
+		if (BranchElementId == ElementId)
+		{
+			return { EBranchElementRole::Branch, static_cast<int16>(BranchIndex) };
+		}
+		const FGameQuestElementBranchList* BranchList = GameQuestCast<FGameQuestElementBranchList>(OwnerQuest->GetElementPtr(BranchElementId));
+		if (BranchList && BranchList->Elements.Contains(ElementId))
+		{
+			return { EBranchElementRole::BranchListMember, static_cast<int16>(BranchIndex) };
+		}
+	}
+	return {};
+}
+
+FGameQuestSequenceBranchElement* FGameQuestSequenceBranch::FindBranch(uint16 BranchElementId)
+{
+	const GameQuest::FBranchElementRole ElementRole = GetElementRole(BranchElementId);
+	return ElementRole.Role == GameQuest::EBranchElementRole::Branch ? &Branches[ElementRole.BranchIndex] : nullptr;
+}
+
 bool FGameQuestSequenceBranch::CanActivateBranchElement() const
 {
 	if (Elements.Num() == 0)
 	{
 		return true;
 	}
-	return CanFinishListElements(Elements, OwnerQuest->GetLogicList(this));
+	return CanFinishListElements(*this, Elements);
 }
 
 void FGameQuestSequenceBranch::ActivateBranches(bool bHasAuthority)
@@ -473,8 +515,11 @@ void FGameQuestSequenceBranch::ActivateBranches(bool bHasAuthority)
 	check(CanActivateBranchElement());
 
 	bIsBranchesActivated = true;
-	OwnerQuest->ActivatedBranches.Add(OwnerQuest->GetSequenceId(this));
+	const uint16 SequenceId = OwnerQuest->GetSequenceId(this);
+	OwnerQuest->ActivatedBranches.Add(SequenceId);
+	UGameQuestGraphBase::SetActivatedBit(OwnerQuest->ActivatedBranchBits, SequenceId, true);
 	MARK_PROPERTY_DIRTY_FROM_NAME(UGameQuestGraphBase, ActivatedBranches, OwnerQuest);
+	OwnerQuest->MarkCompactStateDirty();
 	UE_LOG(LogGameQuest, Verbose, TEXT("ActivateBranches %s.%s"), *OwnerQuest->GetName(), *GetNodeName().ToString());
 	for (const FGameQuestSequenceBranchElement& Branch : Branches)
 	{
@@ -496,8 +541,11 @@ void FGameQuestSequenceBranch::DeactivateBranches(bool bHasAuthority)
 {
 	check(bIsBranchesActivated);
 	bIsBranchesActivated = false;
-	OwnerQuest->ActivatedBranches.Remove(OwnerQuest->GetSequenceId(this));
+	const uint16 SequenceId = OwnerQuest->GetSequenceId(this);
+	OwnerQuest->ActivatedBranches.RemoveSingle(SequenceId);
+	UGameQuestGraphBase::SetActivatedBit(OwnerQuest->ActivatedBranchBits, SequenceId, false);
 	MARK_PROPERTY_DIRTY_FROM_NAME(UGameQuestGraphBase, ActivatedBranches, OwnerQuest);
+	OwnerQuest->MarkCompactStateDirty();
 	for (const FGameQuestSequenceBranchElement& Branch : Branches)
 	{
 		if (Branch.bInterrupted)
@@ -555,9 +603,12 @@ void FGameQuestSequenceSubQuest::WhenSequenceActivated(bool bHasAuthority)
 			SubQuestInstance->Owner = OwnerQuest;
 			SubQuestInstance->OwnerNode = this;
 			SubQuestInstance->BindingRerouteTags();
+			if (bHasAuthority)
+			{
+				OwnerQuest->RegisterReplicatedSubObject(SubQuestInstance);
+			}
 			GetEvaluateGraphExposedInputs(bHasAuthority);
-			using namespace Context;
-			TGuardValue FinishedSequenceGuard{ CurrentFinishedSequenceId, GameQuest::IdNone };
+			TGuardValue FinishedSequenceGuard{ OwnerQuest->GetExecutionContext().CurrentFinishedSequenceId, GameQuest::IdNone };
 			if (CustomEntryName == NAME_None)
 			{
 				SubQuestInstance->DefaultEntry();
@@ -615,6 +666,7 @@ void FGameQuestSequenceSubQuest::WhenSequenceDeactivated(bool bHasAuthority)
 
 void FGameQuestSequenceSubQuest::WhenOnRepValue(const FGameQuestNodeBase& PreValue)
 {
+	Super::WhenOnRepValue(PreValue);
 	const FGameQuestSequenceSubQuest& PreValueImpl = static_cast<const FGameQuestSequenceSubQuest&>(PreValue);
 	if (SubQuestInstance != PreValueImpl.SubQuestInstance)
 	{
@@ -623,14 +675,6 @@ void FGameQuestSequenceSubQuest::WhenOnRepValue(const FGameQuestNodeBase& PreVal
 	}
 }
 
-void FGameQuestSequenceSubQuest::WhenTick(float DeltaSeconds)
-{
-	if (SubQuestInstance && ensure(SubQuestInstance->bIsActivated))
-	{
-		SubQuestInstance->Tick(DeltaSeconds);
-	}
-}
-
 TArray<uint16> FGameQuestSequenceSubQuest::GetNextSequences() const
 {
 	TArray<uint16> NextSequences;
@@ -645,13 +689,10 @@ void FGameQuestSequenceSubQuest::ProcessRerouteTag(const FName& RerouteTagName,
 {
 	check(RerouteTags.ContainsByPredicate([&](const FGameQuestSequenceSubQuestRerouteTag& E){ return E.TagName == RerouteTagName; }) == false);
 	UE_LOG(LogGameQuest, Verbose, TEXT("SubQuestProcessRerouteTag %s.%s.%s"), *GetNodeName().ToString(), *SubQuestInstance->GetName(), *RerouteTagName.ToString());
-	FGameQuestSequenceSubQuestRerouteTag& SubQuestRerouteTag = RerouteTags.Add_GetRef({ RerouteTagName, RerouteTag.PreSequenceId, RerouteTag.PreBranchId, Context::PreRerouteTagName });
-	TGuardValue PreRerouteTagNameGuard{ Context::PreRerouteTagName, RerouteTagName };
-	TGuardValue<Context::FAddNextSequenceIdFunc> AddNextSequenceIdFuncGuard{ Context::AddNextSequenceIdFunc, [this, &SubQuestRerouteTag](const uint16 SequenceId)
-	{
-		SubQuestRerouteTag.NextSequences.Add(SequenceId);
-		MarkNodeNetDirty();
-	}};
+	FGameQuestExecutionContext& Context = OwnerQuest->GetExecutionContext();
+	FGameQuestSequenceSubQuestRerouteTag& SubQuestRerouteTag = RerouteTags.Add_GetRef({ RerouteTagName, RerouteTag.PreSequenceId, RerouteTag.PreBranchId, Context.PreRerouteTagName });
+	TGuardValue PreRerouteTagNameGuard{ Context.PreRerouteTagName, RerouteTagName };
+	TGuardValue SuccessorSinkGuard{ Context.SuccessorSink, FGameQuestSuccessorSink{ SubQuestRerouteTag.NextSequences, *this } };
 	ExecuteFinishEvent(RerouteTag.Event, SubQuestRerouteTag.NextSequences, 0);
 	MarkNodeNetDirty();
 }
@@ -661,7 +702,8 @@ void FGameQuestSequenceSubQuest::WhenSubQuestFinished()
 	DeactivateSequence(OwnerQuest->GetSequenceId(this));
 	if (UFunction* FinishCompletedEvent = OwnerQuest->GetClass()->FindFunctionByName(FGameQuestRerouteTag::MakeEventName(GetNodeName(), FGameQuestRerouteTag::FinishCompletedTagName)))
 	{
-		ProcessRerouteTag(FGameQuestRerouteTag::FinishCompletedTagName, { FinishCompletedEvent, Context::CurrentFinishedSequenceId, Context::CurrentFinishedBranchId });
+		const FGameQuestExecutionContext& Context = OwnerQuest->GetExecutionContext();
+		ProcessRerouteTag(FGameQuestRerouteTag::FinishCompletedTagName, { FinishCompletedEvent, Context.CurrentFinishedSequenceId, Context.CurrentFinishedBranchId });
 	}
 	else
 	{
@@ -672,6 +714,7 @@ void FGameQuestSequenceSubQuest::WhenSubQuestFinished()
 void FGameQuestSequenceSubQuest::WhenSubQuestInterrupted()
 {
 	bInterrupted = true;
+	RefreshSequenceState();
 	MarkNodeNetDirty();
 	DeactivateSequence(OwnerQuest->GetSequenceId(this));
 	OwnerQuest->InvokeInterruptQuest();
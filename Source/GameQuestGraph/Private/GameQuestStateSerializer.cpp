@@ -0,0 +1,1303 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GameQuestStateSerializer.h"
+
+#include "GameQuestComponent.h"
+#include "GameQuestElementBase.h"
+#include "GameQuestGraphBase.h"
+#include "GameQuestGraphBlueprint.h"
+#include "GameQuestSequenceBase.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "Serialization/StructuredArchive.h"
+
+namespace GameQuestStateSerializer
+{
+	enum class ENodeRecord : uint8
+	{
+		Sequence,
+		Single,
+		List,
+		Branch,
+		SubQuest,
+		Element,
+	};
+
+	ENodeRecord GetNodeRecord(const FGameQuestNodeBase* Node)
+	{
+		if (GameQuestCast<FGameQuestElementBase>(Node))
+		{
+			return ENodeRecord::Element;
+		}
+		if (GameQuestCast<FGameQuestSequenceSingle>(Node))
+		{
+			return ENodeRecord::Single;
+		}
+		if (GameQuestCast<FGameQuestSequenceList>(Node))
+		{
+			return ENodeRecord::List;
+		}
+		if (GameQuestCast<FGameQuestSequenceBranch>(Node))
+		{
+			return ENodeRecord::Branch;
+		}
+		if (GameQuestCast<FGameQuestSequenceSubQuest>(Node))
+		{
+			return ENodeRecord::SubQuest;
+		}
+		return ENodeRecord::Sequence;
+	}
+
+	void WriteVarint(FArchive& Ar, uint32 Value)
+	{
+		Ar.SerializeIntPacked(Value);
+	}
+
+	uint32 ReadVarint(FArchive& Ar)
+	{
+		uint32 Value = 0;
+		Ar.SerializeIntPacked(Value);
+		return Value;
+	}
+
+	// Count read from archive can not be larger than the remain bytes, avoid huge allocation from broken data
+	bool ReadCount(FArchive& Ar, uint32& OutCount)
+	{
+		OutCount = ReadVarint(Ar);
+		if (Ar.IsError() || OutCount > Ar.TotalSize() - Ar.Tell())
+		{
+			Ar.SetError();
+			return false;
+		}
+		return true;
+	}
+
+	void WriteIds(FArchive& Ar, const TArray<uint16>& Ids)
+	{
+		WriteVarint(Ar, Ids.Num());
+		for (const uint16 Id : Ids)
+		{
+			WriteVarint(Ar, Id);
+		}
+	}
+
+	// Id of node not exist in current quest graph is dropped
+	template<typename TPredicate>
+	TArray<uint16> ReadIds(FArchive& Ar, const TPredicate& IsValidId)
+	{
+		TArray<uint16> Ids;
+		uint32 Num;
+		if (ReadCount(Ar, Num) == false)
+		{
+			return Ids;
+		}
+		Ids.Reserve(Num);
+		for (uint32 Idx = 0; Idx < Num; ++Idx)
+		{
+			const uint32 Id = ReadVarint(Ar);
+			if (Id <= MAX_uint16 && IsValidId(static_cast<uint16>(Id)))
+			{
+				Ids.Add(Id);
+			}
+		}
+		return Ids;
+	}
+
+	// Bitset trimmed after the last set bit, node id is the bit index
+	void WriteBits(FArchive& Ar, const TBitArray<>& Bits)
+	{
+		const int32 LastIndex = Bits.FindLast(true);
+		const int32 ByteNum = (LastIndex + 8) / 8;
+		WriteVarint(Ar, ByteNum);
+		for (int32 ByteIdx = 0; ByteIdx < ByteNum; ++ByteIdx)
+		{
+			uint8 Byte = 0;
+			for (int32 BitIdx = 0; BitIdx < 8; ++BitIdx)
+			{
+				const int32 Index = ByteIdx * 8 + BitIdx;
+				if (Index <= LastIndex && Bits[Index])
+				{
+					Byte |= 1 << BitIdx;
+				}
+			}
+			Ar << Byte;
+		}
+	}
+
+	TBitArray<> ReadBits(FArchive& Ar)
+	{
+		TBitArray<> Bits;
+		uint32 ByteNum;
+		if (ReadCount(Ar, ByteNum) == false)
+		{
+			return Bits;
+		}
+		Bits.Init(false, ByteNum * 8);
+		for (uint32 ByteIdx = 0; ByteIdx < ByteNum; ++ByteIdx)
+		{
+			uint8 Byte = 0;
+			Ar << Byte;
+			for (int32 BitIdx = 0; BitIdx < 8; ++BitIdx)
+			{
+				Bits[ByteIdx * 8 + BitIdx] = (Byte & (1 << BitIdx)) != 0;
+			}
+		}
+		return Bits;
+	}
+
+	bool GetBit(const TBitArray<>& Bits, int32 Index)
+	{
+		return Bits.IsValidIndex(Index) && Bits[Index];
+	}
+
+	// Payload written to a buffer first, so the reader can skip it by size
+	void WriteFramed(FArchive& Ar, TFunctionRef<void(FArchive&)> WritePayload)
+	{
+		TArray<uint8> Payload;
+		FMemoryWriter PayloadWriter{ Payload };
+		WritePayload(PayloadWriter);
+		WriteVarint(Ar, Payload.Num());
+		Ar.Serialize(Payload.GetData(), Payload.Num());
+	}
+
+	bool ReadFrameEnd(FArchive& Ar, int64& OutEnd)
+	{
+		uint32 Size;
+		if (ReadCount(Ar, Size) == false)
+		{
+			return false;
+		}
+		OutEnd = Ar.Tell() + Size;
+		return true;
+	}
+
+	// Extra SaveGame property is keyed by name and type, value is serialized by the property itself
+	void WriteExtraProperties(FArchive& Ar, const TArray<const FProperty*>& Properties, const void* Container)
+	{
+		WriteVarint(Ar, Properties.Num());
+		for (const FProperty* Property : Properties)
+		{
+			FName Name = Property->GetFName();
+			FName TypeName = Property->GetClass()->GetFName();
+			Ar << Name;
+			Ar << TypeName;
+			WriteFramed(Ar, [&](FArchive& PayloadAr)
+			{
+				FObjectAndNameAsStringProxyArchive ProxyAr{ PayloadAr, false };
+				ProxyAr.ArIsSaveGame = true;
+				FStructuredArchiveFromArchive Adapter{ ProxyAr };
+				Property->SerializeItem(Adapter.GetSlot(), const_cast<void*>(Property->ContainerPtrToValuePtr<void>(Container)), nullptr);
+			});
+		}
+	}
+
+	void ReadExtraProperties(FArchive& Ar, const TArray<const FProperty*>& Properties, void* Container)
+	{
+		uint32 Num;
+		if (ReadCount(Ar, Num) == false)
+		{
+			return;
+		}
+		for (uint32 Idx = 0; Idx < Num && Ar.IsError() == false; ++Idx)
+		{
+			FName Name;
+			FName TypeName;
+			Ar << Name;
+			Ar << TypeName;
+			int64 End;
+			if (ReadFrameEnd(Ar, End) == false)
+			{
+				return;
+			}
+			const FProperty* const* Property = Properties.FindByPredicate([&](const FProperty* E) { return E->GetFName() == Name; });
+			if (Container && Property && (*Property)->GetClass()->GetFName() == TypeName)
+			{
+				FObjectAndNameAsStringProxyArchive ProxyAr{ Ar, true };
+				ProxyAr.ArIsSaveGame = true;
+				FStructuredArchiveFromArchive Adapter{ ProxyAr };
+				(*Property)->SerializeItem(Adapter.GetSlot(), (*Property)->ContainerPtrToValuePtr<void>(Container), nullptr);
+			}
+			Ar.Seek(End);
+		}
+	}
+
+	void GetElementInstanceProperties(const FGameQuestNodeBase* Node, UObject*& OutInstance, TArray<const FProperty*>& OutProperties)
+	{
+		OutInstance = nullptr;
+		if (const FGameQuestElementScript* ElementScript = GameQuestCast<FGameQuestElementScript>(Node))
+		{
+			OutInstance = ElementScript->Instance;
+			if (OutInstance)
+			{
+				FGameQuestStateSerializer::GetExtraSaveProperties(OutInstance->GetClass(), OutProperties);
+			}
+		}
+	}
+
+	enum class EComponentSave : uint8
+	{
+		Full,
+		Delta,
+	};
+
+	struct FArchiveRecordData
+	{
+		FString ClassPath;
+		uint8 Result = 0;
+		FName FinishedRerouteTag;
+		int64 FinishedTicks = 0;
+		TArray<uint16> Path;
+	};
+
+	FArchiveRecordData MakeArchiveRecordData(const FGameQuestArchiveRecord& Record)
+	{
+		return { Record.QuestClass ? Record.QuestClass->GetPathName() : FString{}, static_cast<uint8>(Record.Result), Record.FinishedRerouteTag, Record.FinishedTime.GetTicks(), Record.Path };
+	}
+
+	void SerializeArchiveRecord(FArchive& Ar, FArchiveRecordData& Data)
+	{
+		Ar << Data.ClassPath;
+		Ar << Data.Result;
+		Ar << Data.FinishedRerouteTag;
+		Ar << Data.FinishedTicks;
+		if (Ar.IsLoading())
+		{
+			Data.Path = ReadIds(Ar, [](uint16) { return true; });
+		}
+		else
+		{
+			WriteIds(Ar, Data.Path);
+		}
+	}
+
+	// Quest saved state kept as bytes for compaction, header and node records are replaced by delta without quest object
+	struct FCompactRecord
+	{
+		uint8 Kind = 0;
+		TArray<uint8> Payload;
+	};
+
+	struct FCompactQuest
+	{
+		FString ClassPath;
+		FName Name;
+		bool bFullState = true;
+		TArray<uint8> Header;
+		TMap<uint32, FCompactRecord> Records;
+	};
+
+	TArray<uint8> ReadBytes(FArchive& Ar, int64 End)
+	{
+		TArray<uint8> Bytes;
+		Bytes.SetNumUninitialized(End - Ar.Tell());
+		Ar.Serialize(Bytes.GetData(), Bytes.Num());
+		return Bytes;
+	}
+
+	void WriteBytes(FArchive& Ar, TArray<uint8>& Bytes)
+	{
+		WriteVarint(Ar, Bytes.Num());
+		Ar.Serialize(Bytes.GetData(), Bytes.Num());
+	}
+
+	bool ReadCompactQuest(FArchive& Ar, FCompactQuest& OutQuest)
+	{
+		Ar << OutQuest.ClassPath;
+		Ar << OutQuest.Name;
+		int64 End;
+		if (ReadFrameEnd(Ar, End) == false)
+		{
+			return false;
+		}
+		uint8 bFullState = 0;
+		Ar << bFullState;
+		OutQuest.bFullState = bFullState != 0;
+		int64 HeaderEnd;
+		if (ReadFrameEnd(Ar, HeaderEnd) == false)
+		{
+			return false;
+		}
+		OutQuest.Header = ReadBytes(Ar, HeaderEnd);
+		uint32 RecordNum;
+		if (ReadCount(Ar, RecordNum) == false)
+		{
+			return false;
+		}
+		for (uint32 Idx = 0; Idx < RecordNum; ++Idx)
+		{
+			const uint32 NodeId = ReadVarint(Ar);
+			FCompactRecord Record;
+			Ar << Record.Kind;
+			int64 RecordEnd;
+			if (ReadFrameEnd(Ar, RecordEnd) == false)
+			{
+				return false;
+			}
+			Record.Payload = ReadBytes(Ar, RecordEnd);
+			OutQuest.Records.Add(NodeId, MoveTemp(Record));
+		}
+		if (Ar.IsError())
+		{
+			return false;
+		}
+		Ar.Seek(End);
+		return true;
+	}
+
+	void WriteCompactQuest(FArchive& Ar, FCompactQuest& Quest)
+	{
+		Ar << Quest.ClassPath;
+		Ar << Quest.Name;
+		Quest.Records.KeySort(TLess<uint32>());
+		WriteFramed(Ar, [&](FArchive& StateAr)
+		{
+			uint8 bFullState = 1;
+			StateAr << bFullState;
+			WriteBytes(StateAr, Quest.Header);
+			WriteVarint(StateAr, Quest.Records.Num());
+			for (TPair<uint32, FCompactRecord>& Pair : Quest.Records)
+			{
+				WriteVarint(StateAr, Pair.Key);
+				StateAr << Pair.Value.Kind;
+				WriteBytes(StateAr, Pair.Value.Payload);
+			}
+		});
+	}
+}
+
+void FGameQuestStateSerializer::GetExtraSaveProperties(const UStruct* Struct, TArray<const FProperty*>& OutProperties)
+{
+	// Saved by state layout, node and reroute tag of quest are saved by the node records
+	static const TSet<const FProperty*> LayoutProperties
+	{
+		FindFProperty<FProperty>(UGameQuestGraphBase::StaticClass(), TEXT("bInterrupted")),
+		FindFProperty<FProperty>(UGameQuestGraphBase::StaticClass(), TEXT("StartSequences")),
+		FindFProperty<FProperty>(UGameQuestGraphBase::StaticClass(), TEXT("ActivatedSequences")),
+		FindFProperty<FProperty>(FGameQuestSequenceBase::StaticStruct(), GET_MEMBER_NAME_CHECKED(FGameQuestSequenceBase, PreSequence)),
+		FindFProperty<FProperty>(FGameQuestSequenceBase::StaticStruct(), TEXT("bInterrupted")),
+		FindFProperty<FProperty>(FGameQuestSequenceSingle::StaticStruct(), GET_MEMBER_NAME_CHECKED(FGameQuestSequenceSingle, NextSequences)),
+		FindFProperty<FProperty>(FGameQuestSequenceList::StaticStruct(), GET_MEMBER_NAME_CHECKED(FGameQuestSequenceList, NextSequences)),
+		FindFProperty<FProperty>(FGameQuestSequenceBranch::StaticStruct(), GET_MEMBER_NAME_CHECKED(FGameQuestSequenceBranch, Branches)),
+		FindFProperty<FProperty>(FGameQuestSequenceSubQuest::StaticStruct(), GET_MEMBER_NAME_CHECKED(FGameQuestSequenceSubQuest, SubQuestInstance)),
+		FindFProperty<FProperty>(FGameQuestSequenceSubQuest::StaticStruct(), GET_MEMBER_NAME_CHECKED(FGameQuestSequenceSubQuest, RerouteTags)),
+		FindFProperty<FProperty>(FGameQuestElementBase::StaticStruct(), TEXT("bIsFinished")),
+		FindFProperty<FProperty>(FGameQuestElementScript::StaticStruct(), GET_MEMBER_NAME_CHECKED(FGameQuestElementScript, Instance)),
+	};
+	for (TFieldIterator<FProperty> It{ Struct }; It; ++It)
+	{
+		if (It->HasAnyPropertyFlags(CPF_SaveGame) == false || LayoutProperties.Contains(*It))
+		{
+			continue;
+		}
+		if (const FStructProperty* StructProperty = CastField<FStructProperty>(*It))
+		{
+			if (StructProperty->Struct->IsChildOf(FGameQuestNodeBase::StaticStruct()) || StructProperty->Struct->IsChildOf(FGameQuestRerouteTag::StaticStruct()))
+			{
+				continue;
+			}
+		}
+		OutProperties.Add(*It);
+	}
+}
+
+bool FGameQuestStateSerializer::ReadVersion(FArchive& Ar, EVersion& OutVersion)
+{
+	const uint32 Version = GameQuestStateSerializer::ReadVarint(Ar);
+	if (Ar.IsError() || Version == 0 || Version > static_cast<uint32>(EVersion::Latest))
+	{
+		UE_LOG(LogGameQuest, Warning, TEXT("Unsupported quest state version %u"), Version);
+		return false;
+	}
+	OutVersion = static_cast<EVersion>(Version);
+	return true;
+}
+
+void FGameQuestStateSerializer::WriteQuest(FArchive& Ar, const UGameQuestGraphBase& Quest, uint32 SinceGeneration)
+{
+	FString ClassPath = Quest.GetClass()->GetPathName();
+	FName Name = Quest.GetFName();
+	Ar << ClassPath;
+	Ar << Name;
+	GameQuestStateSerializer::WriteFramed(Ar, [&](FArchive& StateAr) { WriteQuestState(StateAr, Quest, SinceGeneration); });
+}
+
+UGameQuestGraphBase* FGameQuestStateSerializer::ReadQuest(FArchive& Ar, UObject* Outer, EVersion Version, FName* OutRenamedFrom)
+{
+	FString ClassPath;
+	FName Name;
+	Ar << ClassPath;
+	if (Version >= EVersion::DeltaSave)
+	{
+		Ar << Name;
+	}
+	int64 End;
+	if (GameQuestStateSerializer::ReadFrameEnd(Ar, End) == false)
+	{
+		return nullptr;
+	}
+	UGameQuestGraphBase* Quest = nullptr;
+	const TSubclassOf<UGameQuestGraphBase> QuestClass = TSoftClassPtr<UGameQuestGraphBase>{ FSoftObjectPath{ ClassPath } }.LoadSynchronous();
+	if (QuestClass && QuestClass->IsA<UGameQuestGraphGeneratedClass>())
+	{
+		// Name is the key of quest in delta save, renamed quest can not be merged with older delta
+		if (Name != NAME_None && StaticFindObjectFast(nullptr, Outer, Name))
+		{
+			UE_LOG(LogGameQuest, Warning, TEXT("Quest name %s of saved state already used in %s, renamed"), *Name.ToString(), *Outer->GetName());
+			if (OutRenamedFrom)
+			{
+				*OutRenamedFrom = Name;
+			}
+			Name = NAME_None;
+		}
+		Quest = NewObject<UGameQuestGraphBase>(Outer, QuestClass, Name);
+		if (ReadQuestState(Ar, *Quest, Version) == false)
+		{
+			UE_LOG(LogGameQuest, Warning, TEXT("Restore quest %s state failed"), *Quest->GetName());
+			Quest = nullptr;
+		}
+	}
+	else
+	{
+		UE_LOG(LogGameQuest, Warning, TEXT("Quest class %s of saved state not found, skipped"), *ClassPath);
+	}
+	if (Ar.IsError() == false)
+	{
+		Ar.Seek(End);
+	}
+	return Quest;
+}
+
+void FGameQuestStateSerializer::WriteQuestState(FArchive& Ar, const UGameQuestGraphBase& Quest, uint32 SinceGeneration)
+{
+	using namespace GameQuestStateSerializer;
+	using ENodeKind = UGameQuestGraphGeneratedClass::ENodeKind;
+	const UGameQuestGraphGeneratedClass* Class = CastChecked<UGameQuestGraphGeneratedClass>(Quest.GetClass());
+	if (!ensure(Class->IsRuntimeTablesBuilt()))
+	{
+		Ar.SetError();
+		return;
+	}
+	const UGameQuestGraphGeneratedClass::FSaveStateLayout& Layout = Class->SaveStateLayout;
+
+	// Delta only has records of node changed after since generation, quest added after it is full
+	uint8 bFullState = SinceGeneration == 0 || Quest.FullSaveGeneration > SinceGeneration;
+	auto IsNodeChanged = [&](int32 NodeId) { return bFullState || Quest.GetNodeSaveGeneration(NodeId) > SinceGeneration; };
+
+	const int32 NodeNum = Class->NodeTable.Num();
+	TBitArray<> FinishedElements{ false, NodeNum };
+	TBitArray<> InterruptedSequences{ false, NodeNum };
+	TBitArray<> InterruptedBranches{ false, NodeNum };
+	TArray<uint8> Records;
+	FMemoryWriter RecordWriter{ Records };
+	uint32 RecordNum = 0;
+	TArray<const FProperty*> ExtraProperties;
+	auto WriteRecord = [&](int32 NodeId, ENodeRecord Record, TFunctionRef<void(FArchive&)> WritePayload)
+	{
+		RecordNum += 1;
+		WriteVarint(RecordWriter, NodeId);
+		uint8 RecordValue = static_cast<uint8>(Record);
+		RecordWriter << RecordValue;
+		WriteFramed(RecordWriter, WritePayload);
+	};
+	auto WriteNodeExtraProperties = [&](FArchive& RecordAr, const FGameQuestNodeBase* Node, bool bHasExtraState)
+	{
+		ExtraProperties.Reset();
+		if (bHasExtraState)
+		{
+			GetExtraSaveProperties(Node->GetNodeStruct(), ExtraProperties);
+		}
+		WriteExtraProperties(RecordAr, ExtraProperties, Node);
+	};
+
+	for (int32 NodeId = 0; NodeId < NodeNum; ++NodeId)
+	{
+		const bool bHasExtraState = Layout.ExtraStateNodes[NodeId];
+		if (Class->NodeTable[NodeId].Kind == ENodeKind::Element)
+		{
+			const FGameQuestElementBase* Element = Quest.GetElementPtr(NodeId);
+			FinishedElements[NodeId] = Element->bIsFinished != 0;
+			if (bHasExtraState == false || IsNodeChanged(NodeId) == false)
+			{
+				continue;
+			}
+			WriteRecord(NodeId, ENodeRecord::Element, [&](FArchive& RecordAr)
+			{
+				WriteNodeExtraProperties(RecordAr, Element, true);
+				UObject* Instance;
+				ExtraProperties.Reset();
+				GetElementInstanceProperties(Element, Instance, ExtraProperties);
+				WriteExtraProperties(RecordAr, ExtraProperties, Instance);
+			});
+			continue;
+		}
+		if (Class->NodeTable[NodeId].Kind != ENodeKind::Sequence)
+		{
+			continue;
+		}
+
+		const FGameQuestSequenceBase* Sequence = Quest.GetSequencePtr(NodeId);
+		InterruptedSequences[NodeId] = Sequence->bInterrupted != 0;
+		const ENodeRecord Record = GetNodeRecord(Sequence);
+		bool bHasState = bHasExtraState || Sequence->PreSequence != GameQuest::IdNone;
+		switch (Record)
+		{
+		case ENodeRecord::Single:
+			bHasState |= static_cast<const FGameQuestSequenceSingle*>(Sequence)->NextSequences.Num() > 0;
+			break;
+		case ENodeRecord::List:
+			bHasState |= static_cast<const FGameQuestSequenceList*>(Sequence)->NextSequences.Num() > 0;
+			break;
+		case ENodeRecord::Branch:
+			for (const FGameQuestSequenceBranchElement& Branch : static_cast<const FGameQuestSequenceBranch*>(Sequence)->Branches)
+			{
+				InterruptedBranches[Branch.Element] = Branch.bInterrupted != 0;
+				bHasState |= Branch.NextSequences.Num() > 0;
+			}
+			break;
+		case ENodeRecord::SubQuest:
+		{
+			const FGameQuestSequenceSubQuest* SubQuest = static_cast<const FGameQuestSequenceSubQuest*>(Sequence);
+			bHasState |= SubQuest->RerouteTags.Num() > 0 || SubQuest->SubQuestInstance != nullptr;
+			break;
+		}
+		default:
+			break;
+		}
+		if (IsNodeChanged(NodeId) == false)
+		{
+			continue;
+		}
+		if (bHasState == false)
+		{
+			// Empty record reset node state when merged by CompactSave
+			if (bFullState == false)
+			{
+				WriteRecord(NodeId, Record, [](FArchive&) {});
+			}
+			continue;
+		}
+		WriteRecord(NodeId, Record, [&](FArchive& RecordAr)
+		{
+			WriteVarint(RecordAr, Sequence->PreSequence);
+			switch (Record)
+			{
+			case ENodeRecord::Single:
+				WriteIds(RecordAr, static_cast<const FGameQuestSequenceSingle*>(Sequence)->NextSequences);
+				break;
+			case ENodeRecord::List:
+				WriteIds(RecordAr, static_cast<const FGameQuestSequenceList*>(Sequence)->NextSequences);
+				break;
+			case ENodeRecord::Branch:
+			{
+				const TArray<FGameQuestSequenceBranchElement>& Branches = static_cast<const FGameQuestSequenceBranch*>(Sequence)->Branches;
+				WriteVarint(RecordAr, Branches.Num());
+				for (const FGameQuestSequenceBranchElement& Branch : Branches)
+				{
+					WriteVarint(RecordAr, Branch.Element);
+					WriteIds(RecordAr, Branch.NextSequences);
+				}
+				break;
+			}
+			case ENodeRecord::SubQuest:
+			{
+				const FGameQuestSequenceSubQuest* SubQuest = static_cast<const FGameQuestSequenceSubQuest*>(Sequence);
+				WriteVarint(RecordAr, SubQuest->RerouteTags.Num());
+				for (const FGameQuestSequenceSubQuestRerouteTag& RerouteTag : SubQuest->RerouteTags)
+				{
+					FName TagName = RerouteTag.TagName;
+					FName PreRerouteTagName = RerouteTag.PreRerouteTagName;
+					RecordAr << TagName;
+					WriteVarint(RecordAr, RerouteTag.PreSubQuestSequence);
+					WriteVarint(RecordAr, RerouteTag.PreSubQuestBranch);
+					RecordAr << PreRerouteTagName;
+					WriteIds(RecordAr, RerouteTag.NextSequences);
+				}
+				uint8 bHasInstance = SubQuest->SubQuestInstance != nullptr;
+				RecordAr << bHasInstance;
+				if (bHasInstance)
+				{
+					WriteQuest(RecordAr, *SubQuest->SubQuestInstance);
+				}
+				break;
+			}
+			default:
+				break;
+			}
+			WriteNodeExtraProperties(RecordAr, Sequence, bHasExtraState);
+		});
+	}
+
+	TArray<TPair<FName, const FGameQuestRerouteTag*>, TInlineAllocator<4>> RerouteTags;
+	for (const auto& [Name, StructProperty] : Class->RerouteTags)
+	{
+		const FGameQuestRerouteTag* RerouteTag = StructProperty->ContainerPtrToValuePtr<FGameQuestRerouteTag>(&Quest);
+		if (RerouteTag->PreSequenceId != GameQuest::IdNone || RerouteTag->PreBranchId != GameQuest::IdNone)
+		{
+			RerouteTags.Emplace(Name, RerouteTag);
+		}
+	}
+
+	// Header is always written whole, delta replace it directly
+	Ar << bFullState;
+	WriteFramed(Ar, [&](FArchive& HeaderAr)
+	{
+		uint8 QuestFlags = Quest.bInterrupted ? 1 : 0;
+		HeaderAr << QuestFlags;
+		WriteIds(HeaderAr, Quest.StartSequences);
+		WriteIds(HeaderAr, Quest.ActivatedSequences);
+
+		WriteBits(HeaderAr, FinishedElements);
+		WriteBits(HeaderAr, InterruptedSequences);
+		WriteBits(HeaderAr, InterruptedBranches);
+
+		WriteVarint(HeaderAr, RerouteTags.Num());
+		for (const auto& [Name, RerouteTag] : RerouteTags)
+		{
+			FName TagName = Name;
+			HeaderAr << TagName;
+			WriteVarint(HeaderAr, RerouteTag->PreSequenceId);
+			WriteVarint(HeaderAr, RerouteTag->PreBranchId);
+		}
+
+		WriteExtraProperties(HeaderAr, Layout.ExtraProperties, &Quest);
+	});
+
+	WriteVarint(Ar, RecordNum);
+	Ar.Serialize(Records.GetData(), Records.Num());
+}
+
+bool FGameQuestStateSerializer::ReadQuestState(FArchive& Ar, UGameQuestGraphBase& Quest, EVersion Version)
+{
+	using namespace GameQuestStateSerializer;
+	using ENodeKind = UGameQuestGraphGeneratedClass::ENodeKind;
+	if (!ensure(Quest.bIsActivated == false && Quest.GetQuestState() == UGameQuestGraphBase::EState::Unactivated))
+	{
+		return false;
+	}
+	const UGameQuestGraphGeneratedClass* Class = CastChecked<UGameQuestGraphGeneratedClass>(Quest.GetClass());
+	if (!ensure(Class->IsRuntimeTablesBuilt()))
+	{
+		return false;
+	}
+	const UGameQuestGraphGeneratedClass::FSaveStateLayout& Layout = Class->SaveStateLayout;
+	const TArray<UGameQuestGraphGeneratedClass::FNodeEntry>& NodeTable = Class->NodeTable;
+	// Saved by older quest graph, node removed or changed kind is dropped
+	auto IsNodeId = [&NodeTable](uint32 Id) { return NodeTable.IsValidIndex(Id) && NodeTable[Id].Kind != ENodeKind::None; };
+	auto IsSequenceId = [&NodeTable](uint32 Id) { return NodeTable.IsValidIndex(Id) && NodeTable[Id].Kind == ENodeKind::Sequence; };
+	auto ReadNodeId = [&](FArchive& NodeAr, bool bSequence)
+	{
+		const uint32 Id = ReadVarint(NodeAr);
+		return (bSequence ? IsSequenceId(Id) : IsNodeId(Id)) ? static_cast<uint16>(Id) : GameQuest::IdNone;
+	};
+	TArray<const FProperty*> ExtraProperties;
+	auto ReadNodeExtraProperties = [&](FArchive& RecordAr, FGameQuestNodeBase* Node)
+	{
+		ExtraProperties.Reset();
+		GetExtraSaveProperties(Node->GetNodeStruct(), ExtraProperties);
+		ReadExtraProperties(RecordAr, ExtraProperties, Node);
+	};
+
+	int64 HeaderEnd = INDEX_NONE;
+	if (Version >= EVersion::DeltaSave)
+	{
+		uint8 bFullState = 0;
+		Ar << bFullState;
+		if (bFullState == 0)
+		{
+			UE_LOG(LogGameQuest, Warning, TEXT("Quest %s saved state is delta, compact it with base save first"), *Quest.GetName());
+			return false;
+		}
+		if (ReadFrameEnd(Ar, HeaderEnd) == false)
+		{
+			return false;
+		}
+	}
+	uint8 QuestFlags = 0;
+	Ar << QuestFlags;
+	Quest.bInterrupted = (QuestFlags & 1) != 0;
+	Quest.StartSequences = ReadIds(Ar, IsSequenceId);
+	Quest.ActivatedSequences = ReadIds(Ar, IsSequenceId);
+	const TBitArray<> FinishedElements = ReadBits(Ar);
+	const TBitArray<> InterruptedSequences = ReadBits(Ar);
+	const TBitArray<> InterruptedBranches = ReadBits(Ar);
+	for (int32 NodeId = 0; NodeId < NodeTable.Num(); ++NodeId)
+	{
+		if (NodeTable[NodeId].Kind == ENodeKind::Element)
+		{
+			Quest.GetElementPtr(NodeId)->bIsFinished = GetBit(FinishedElements, NodeId);
+		}
+		else if (NodeTable[NodeId].Kind == ENodeKind::Sequence)
+		{
+			FGameQuestSequenceBase* Sequence = Quest.GetSequencePtr(NodeId);
+			Sequence->bInterrupted = GetBit(InterruptedSequences, NodeId);
+			if (FGameQuestSequenceBranch* SequenceBranch = GameQuestCast<FGameQuestSequenceBranch>(Sequence))
+			{
+				for (FGameQuestSequenceBranchElement& Branch : SequenceBranch->Branches)
+				{
+					Branch.bInterrupted = GetBit(InterruptedBranches, Branch.Element);
+				}
+			}
+		}
+	}
+
+	uint32 RerouteTagNum;
+	if (ReadCount(Ar, RerouteTagNum) == false)
+	{
+		return false;
+	}
+	for (uint32 Idx = 0; Idx < RerouteTagNum; ++Idx)
+	{
+		FName TagName;
+		Ar << TagName;
+		const uint16 PreSequenceId = ReadNodeId(Ar, true);
+		const uint16 PreBranchId = ReadNodeId(Ar, false);
+		if (const FStructProperty* StructProperty = Class->RerouteTags.FindRef(TagName))
+		{
+			FGameQuestRerouteTag* RerouteTag = StructProperty->ContainerPtrToValuePtr<FGameQuestRerouteTag>(&Quest);
+			RerouteTag->PreSequenceId = PreSequenceId;
+			RerouteTag->PreBranchId = PreBranchId;
+		}
+	}
+
+	ReadExtraProperties(Ar, Layout.ExtraProperties, &Quest);
+	if (HeaderEnd != INDEX_NONE && Ar.IsError() == false)
+	{
+		Ar.Seek(HeaderEnd);
+	}
+
+	uint32 RecordNum;
+	if (ReadCount(Ar, RecordNum) == false)
+	{
+		return false;
+	}
+	for (uint32 RecordIdx = 0; RecordIdx < RecordNum; ++RecordIdx)
+	{
+		const uint32 NodeId = ReadVarint(Ar);
+		uint8 RecordValue = 0;
+		Ar << RecordValue;
+		int64 End;
+		if (ReadFrameEnd(Ar, End) == false)
+		{
+			return false;
+		}
+		// Empty record only in delta, reset node is the default state
+		if (Ar.Tell() == End)
+		{
+			continue;
+		}
+		const ENodeRecord Record = static_cast<ENodeRecord>(RecordValue);
+		FGameQuestNodeBase* Node = nullptr;
+		if (IsSequenceId(NodeId))
+		{
+			Node = Quest.GetSequencePtr(NodeId);
+		}
+		else if (IsNodeId(NodeId))
+		{
+			Node = Quest.GetElementPtr(NodeId);
+		}
+		if (Node == nullptr || GetNodeRecord(Node) != Record)
+		{
+			UE_LOG(LogGameQuest, Verbose, TEXT("Skip saved state of node %u in %s, node is removed or changed"), NodeId, *Quest.GetName());
+			Ar.Seek(End);
+			continue;
+		}
+
+		if (Record == ENodeRecord::Element)
+		{
+			ReadNodeExtraProperties(Ar, Node);
+			UObject* Instance;
+			ExtraProperties.Reset();
+			GetElementInstanceProperties(Node, Instance, ExtraProperties);
+			ReadExtraProperties(Ar, ExtraProperties, Instance);
+			Ar.Seek(End);
+			continue;
+		}
+
+		FGameQuestSequenceBase* Sequence = static_cast<FGameQuestSequenceBase*>(Node);
+		Sequence->PreSequence = ReadNodeId(Ar, true);
+		switch (Record)
+		{
+		case ENodeRecord::Single:
+			static_cast<FGameQuestSequenceSingle*>(Sequence)->NextSequences = ReadIds(Ar, IsSequenceId);
+			break;
+		case ENodeRecord::List:
+			static_cast<FGameQuestSequenceList*>(Sequence)->NextSequences = ReadIds(Ar, IsSequenceId);
+			break;
+		case ENodeRecord::Branch:
+		{
+			FGameQuestSequenceBranch* SequenceBranch = static_cast<FGameQuestSequenceBranch*>(Sequence);
+			uint32 BranchNum;
+			if (ReadCount(Ar, BranchNum) == false)
+			{
+				return false;
+			}
+			for (uint32 Idx = 0; Idx < BranchNum; ++Idx)
+			{
+				const uint32 BranchElementId = ReadVarint(Ar);
+				TArray<uint16> NextSequences = ReadIds(Ar, IsSequenceId);
+				// Branch is matched by element id, branch added or removed after saved keep its default
+				if (FGameQuestSequenceBranchElement* Branch = BranchElementId <= MAX_uint16 ? SequenceBranch->FindBranch(static_cast<uint16>(BranchElementId)) : nullptr)
+				{
+					Branch->NextSequences = MoveTemp(NextSequences);
+				}
+			}
+			break;
+		}
+		case ENodeRecord::SubQuest:
+		{
+			FGameQuestSequenceSubQuest* SubQuest = static_cast<FGameQuestSequenceSubQuest*>(Sequence);
+			uint32 RerouteTagNum;
+			if (ReadCount(Ar, RerouteTagNum) == false)
+			{
+				return false;
+			}
+			SubQuest->RerouteTags.Reset(RerouteTagNum);
+			for (uint32 Idx = 0; Idx < RerouteTagNum; ++Idx)
+			{
+				FGameQuestSequenceSubQuestRerouteTag& RerouteTag = SubQuest->RerouteTags.AddDefaulted_GetRef();
+				Ar << RerouteTag.TagName;
+				RerouteTag.PreSubQuestSequence = static_cast<uint16>(ReadVarint(Ar));
+				RerouteTag.PreSubQuestBranch = static_cast<uint16>(ReadVarint(Ar));
+				Ar << RerouteTag.PreRerouteTagName;
+				RerouteTag.NextSequences = ReadIds(Ar, IsSequenceId);
+			}
+			uint8 bHasInstance = 0;
+			Ar << bHasInstance;
+			if (bHasInstance)
+			{
+				if (UGameQuestGraphBase* SubQuestInstance = ReadQuest(Ar, &Quest, Version))
+				{
+					SubQuest->SubQuestInstance = SubQuestInstance;
+					SubQuestInstance->Owner = &Quest;
+					SubQuestInstance->OwnerNode = SubQuest;
+					SubQuestInstance->BindingRerouteTags();
+				}
+			}
+			break;
+		}
+		default:
+			break;
+		}
+		ReadNodeExtraProperties(Ar, Sequence);
+		if (Ar.IsError())
+		{
+			return false;
+		}
+		Ar.Seek(End);
+	}
+	if (Ar.IsError())
+	{
+		return false;
+	}
+
+	Quest.RebuildActivatedBits();
+	Quest.bListFinishedMasksDirty = true;
+	Quest.RefreshSequenceStates();
+	Quest.MarkCompactStateDirty();
+	for (const uint16 SequenceId : Quest.ActivatedSequences)
+	{
+		FGameQuestSequenceBase* Sequence = Quest.GetSequencePtr(SequenceId);
+		if (Sequence->ShouldReplicatedSubobject())
+		{
+			Quest.AddReplicateSubobjectNode(Sequence);
+		}
+	}
+	return true;
+}
+
+void FGameQuestStateSerializer::SaveQuest(const UGameQuestGraphBase& Quest, TArray<uint8>& OutData)
+{
+	FMemoryWriter Ar{ OutData };
+	GameQuestStateSerializer::WriteVarint(Ar, static_cast<uint32>(EVersion::Latest));
+	WriteQuest(Ar, Quest);
+}
+
+UGameQuestGraphBase* FGameQuestStateSerializer::LoadQuest(UGameQuestComponent& Component, const TArray<uint8>& Data, bool bAutoActivate)
+{
+	FMemoryReader Ar{ Data };
+	EVersion Version;
+	if (ReadVersion(Ar, Version) == false)
+	{
+		return nullptr;
+	}
+	UGameQuestGraphBase* Quest = ReadQuest(Ar, &Component, Version);
+	if (Quest == nullptr || Ar.IsError())
+	{
+		return nullptr;
+	}
+	Component.AddQuest(Quest, bAutoActivate);
+	return Quest;
+}
+
+uint32 FGameQuestStateSerializer::SaveComponent(UGameQuestComponent& Component, TArray<uint8>& OutData)
+{
+	using namespace GameQuestStateSerializer;
+	const uint32 Generation = Component.SaveGeneration++;
+	Component.FullSaveGeneration = Generation;
+	Component.RemovedQuestSaves.Reset();
+
+	FMemoryWriter Ar{ OutData };
+	WriteVarint(Ar, static_cast<uint32>(EVersion::Latest));
+	uint8 SaveKind = static_cast<uint8>(EComponentSave::Full);
+	Ar << SaveKind;
+	WriteVarint(Ar, Generation);
+	// Activated and finished quests in one list, AddQuest put quest to list by its state
+	WriteVarint(Ar, Component.ActivatedQuests.Num() + Component.FinishedQuests.Num());
+	for (const TArray<TObjectPtr<UGameQuestGraphBase>>* Quests : { &Component.ActivatedQuests, &Component.FinishedQuests })
+	{
+		for (const UGameQuestGraphBase* Quest : *Quests)
+		{
+			WriteQuest(Ar, *Quest);
+		}
+	}
+	const TArray<FGameQuestArchiveRecord>& ArchivedQuests = Component.GetArchivedQuests();
+	WriteVarint(Ar, ArchivedQuests.Num());
+	for (const FGameQuestArchiveRecord& Record : ArchivedQuests)
+	{
+		FArchiveRecordData RecordData = MakeArchiveRecordData(Record);
+		SerializeArchiveRecord(Ar, RecordData);
+	}
+	return Generation;
+}
+
+bool FGameQuestStateSerializer::LoadComponent(UGameQuestComponent& Component, const TArray<uint8>& Data)
+{
+	using namespace GameQuestStateSerializer;
+	FMemoryReader Ar{ Data };
+	EVersion Version;
+	if (ReadVersion(Ar, Version) == false)
+	{
+		return false;
+	}
+	uint32 Generation = 0;
+	int32 ListNum = 2;
+	if (Version >= EVersion::DeltaSave)
+	{
+		uint8 SaveKind = 0;
+		Ar << SaveKind;
+		if (SaveKind != static_cast<uint8>(EComponentSave::Full))
+		{
+			UE_LOG(LogGameQuest, Warning, TEXT("Delta quest state can not be loaded, compact it with base save first"));
+			return false;
+		}
+		Generation = ReadVarint(Ar);
+		ListNum = 1;
+	}
+	// Delta save can continue from loaded generation only when component is empty, otherwise next delta need a full save first
+	const bool bContinueGeneration = Generation != 0 && Component.ActivatedQuests.Num() == 0 && Component.FinishedQuests.Num() == 0 && Component.GetArchivedQuests().Num() == 0;
+	if (bContinueGeneration)
+	{
+		Component.SaveGeneration = FMath::Max(Component.SaveGeneration, Generation + 1);
+		Component.FullSaveGeneration = Generation;
+		Component.RemovedQuestSaves.Reset();
+	}
+	else
+	{
+		Component.FullSaveGeneration = Component.SaveGeneration;
+	}
+
+	TGuardValue SuppressSaveStateDirtyGuard{ Component.bSuppressSaveStateDirty, true };
+	for (int32 ListIdx = 0; ListIdx < ListNum; ++ListIdx)
+	{
+		uint32 QuestNum;
+		if (ReadCount(Ar, QuestNum) == false)
+		{
+			return false;
+		}
+		for (uint32 Idx = 0; Idx < QuestNum; ++Idx)
+		{
+			FName RenamedFrom;
+			UGameQuestGraphBase* Quest = ReadQuest(Ar, &Component, Version, &RenamedFrom);
+			if (Ar.IsError())
+			{
+				return false;
+			}
+			if (Quest)
+			{
+				Component.AddQuest(Quest);
+				if (RenamedFrom == NAME_None)
+				{
+					Quest->FullSaveGeneration = Component.FullSaveGeneration;
+				}
+				else
+				{
+					// Base save only has the saved name, next delta replace it by full record of the new name
+					Component.RemovedQuestSaves.Add({ RenamedFrom, Component.SaveGeneration });
+				}
+			}
+		}
+	}
+
+	uint32 RecordNum;
+	if (ReadCount(Ar, RecordNum) == false)
+	{
+		return false;
+	}
+	for (uint32 Idx = 0; Idx < RecordNum; ++Idx)
+	{
+		FArchiveRecordData RecordData;
+		SerializeArchiveRecord(Ar, RecordData);
+		if (Ar.IsError())
+		{
+			return false;
+		}
+		const TSubclassOf<UGameQuestGraphBase> QuestClass = TSoftClassPtr<UGameQuestGraphBase>{ FSoftObjectPath{ RecordData.ClassPath } }.LoadSynchronous();
+		if (QuestClass == nullptr)
+		{
+			UE_LOG(LogGameQuest, Warning, TEXT("Quest class %s of archived quest not found, skipped"), *RecordData.ClassPath);
+			continue;
+		}
+		FGameQuestArchiveRecord& Record = Component.ArchivedQuests.Items.AddDefaulted_GetRef();
+		Record.QuestClass = QuestClass;
+		Record.Result = RecordData.Result == static_cast<uint8>(EGameQuestArchiveResult::Interrupted) ? EGameQuestArchiveResult::Interrupted : EGameQuestArchiveResult::Finished;
+		Record.FinishedRerouteTag = RecordData.FinishedRerouteTag;
+		Record.FinishedTime = FDateTime{ RecordData.FinishedTicks };
+		Record.Path = MoveTemp(RecordData.Path);
+		Record.SaveGeneration = Component.FullSaveGeneration;
+		Component.ArchivedQuests.MarkItemDirty(Record);
+		MARK_PROPERTY_DIRTY_FROM_NAME(UGameQuestComponent, ArchivedQuests, &Component);
+		Component.WhenArchivedQuestAdded(Record);
+	}
+	return true;
+}
+
+uint32 FGameQuestStateSerializer::SaveComponentDelta(UGameQuestComponent& Component, uint32 SinceGeneration, TArray<uint8>& OutData)
+{
+	using namespace GameQuestStateSerializer;
+	// Removed quests before the last full save are forgot, delta based on older generation can not be merged correctly
+	if (SinceGeneration == 0 || SinceGeneration < Component.FullSaveGeneration || SinceGeneration >= Component.SaveGeneration)
+	{
+		UE_LOG(LogGameQuest, Warning, TEXT("Can not save quest delta since generation %u of %s, last full save generation is %u"), SinceGeneration, *Component.GetName(), Component.FullSaveGeneration);
+		return 0;
+	}
+	const uint32 Generation = Component.SaveGeneration++;
+
+	FMemoryWriter Ar{ OutData };
+	WriteVarint(Ar, static_cast<uint32>(EVersion::Latest));
+	uint8 SaveKind = static_cast<uint8>(EComponentSave::Delta);
+	Ar << SaveKind;
+	WriteVarint(Ar, SinceGeneration);
+	WriteVarint(Ar, Generation);
+
+	// Removed before changed quests, so quest added again with same name is kept by compaction
+	TArray<FName, TInlineAllocator<8>> RemovedQuests;
+	for (const UGameQuestComponent::FRemovedQuestSave& RemovedQuestSave : Component.RemovedQuestSaves)
+	{
+		if (RemovedQuestSave.Generation > SinceGeneration)
+		{
+			RemovedQuests.AddUnique(RemovedQuestSave.Name);
+		}
+	}
+	WriteVarint(Ar, RemovedQuests.Num());
+	for (FName& Name : RemovedQuests)
+	{
+		Ar << Name;
+	}
+
+	TArray<const UGameQuestGraphBase*, TInlineAllocator<8>> ChangedQuests;
+	for (const TArray<TObjectPtr<UGameQuestGraphBase>>* Quests : { &Component.ActivatedQuests, &Component.FinishedQuests })
+	{
+		for (const UGameQuestGraphBase* Quest : *Quests)
+		{
+			if (FMath::Max(Quest->SaveGeneration, Quest->FullSaveGeneration) > SinceGeneration)
+			{
+				ChangedQuests.Add(Quest);
+			}
+		}
+	}
+	WriteVarint(Ar, ChangedQuests.Num());
+	for (const UGameQuestGraphBase* Quest : ChangedQuests)
+	{
+		WriteQuest(Ar, *Quest, SinceGeneration);
+	}
+
+	// Archived record is only appended, generation avoid appending it twice by overlapped deltas
+	TArray<const FGameQuestArchiveRecord*, TInlineAllocator<8>> AddedRecords;
+	for (const FGameQuestArchiveRecord& Record : Component.GetArchivedQuests())
+	{
+		if (Record.SaveGeneration > SinceGeneration)
+		{
+			AddedRecords.Add(&Record);
+		}
+	}
+	WriteVarint(Ar, AddedRecords.Num());
+	for (const FGameQuestArchiveRecord* Record : AddedRecords)
+	{
+		WriteVarint(Ar, Record->SaveGeneration);
+		FArchiveRecordData RecordData = MakeArchiveRecordData(*Record);
+		SerializeArchiveRecord(Ar, RecordData);
+	}
+	return Generation;
+}
+
+bool FGameQuestStateSerializer::CompactSave(const TArray<uint8>& BaseData, TConstArrayView<TArray<uint8>> DeltaDatas, TArray<uint8>& OutData)
+{
+	using namespace GameQuestStateSerializer;
+	auto ReadHeader = [](FMemoryReader& Ar, EComponentSave ExpectedKind)
+	{
+		EVersion Version;
+		if (ReadVersion(Ar, Version) == false)
+		{
+			return false;
+		}
+		// Quest saved before delta save has no name, can not be matched by delta
+		if (Version < EVersion::DeltaSave)
+		{
+			UE_LOG(LogGameQuest, Warning, TEXT("Quest state of version %u can not be compacted, load and save it again"), static_cast<uint32>(Version));
+			return false;
+		}
+		uint8 SaveKind = 0;
+		Ar << SaveKind;
+		return Ar.IsError() == false && SaveKind == static_cast<uint8>(ExpectedKind);
+	};
+
+	TArray<FCompactQuest> Quests;
+	TArray<FArchiveRecordData> ArchivedRecords;
+	uint32 Generation;
+	{
+		FMemoryReader Ar{ BaseData };
+		if (ReadHeader(Ar, EComponentSave::Full) == false)
+		{
+			return false;
+		}
+		Generation = ReadVarint(Ar);
+		uint32 QuestNum;
+		if (ReadCount(Ar, QuestNum) == false)
+		{
+			return false;
+		}
+		for (uint32 Idx = 0; Idx < QuestNum; ++Idx)
+		{
+			if (ReadCompactQuest(Ar, Quests.AddDefaulted_GetRef()) == false)
+			{
+				return false;
+			}
+		}
+		uint32 RecordNum;
+		if (ReadCount(Ar, RecordNum) == false)
+		{
+			return false;
+		}
+		for (uint32 Idx = 0; Idx < RecordNum; ++Idx)
+		{
+			SerializeArchiveRecord(Ar, ArchivedRecords.AddDefaulted_GetRef());
+		}
+		if (Ar.IsError())
+		{
+			return false;
+		}
+	}
+
+	for (const TArray<uint8>& DeltaData : DeltaDatas)
+	{
+		FMemoryReader Ar{ DeltaData };
+		if (ReadHeader(Ar, EComponentSave::Delta) == false)
+		{
+			return false;
+		}
+		const uint32 BaseGeneration = ReadVarint(Ar);
+		const uint32 DeltaGeneration = ReadVarint(Ar);
+		if (BaseGeneration > Generation || DeltaGeneration <= Generation)
+		{
+			UE_LOG(LogGameQuest, Warning, TEXT("Quest delta from generation %u to %u can not be merged into generation %u"), BaseGeneration, DeltaGeneration, Generation);
+			return false;
+		}
+
+		uint32 RemovedNum;
+		if (ReadCount(Ar, RemovedNum) == false)
+		{
+			return false;
+		}
+		for (uint32 Idx = 0; Idx < RemovedNum; ++Idx)
+		{
+			FName Name;
+			Ar << Name;
+			Quests.RemoveAll([&](const FCompactQuest& E) { return E.Name == Name; });
+		}
+
+		uint32 QuestNum;
+		if (ReadCount(Ar, QuestNum) == false)
+		{
+			return false;
+		}
+		for (uint32 Idx = 0; Idx < QuestNum; ++Idx)
+		{
+			FCompactQuest DeltaQuest;
+			if (ReadCompactQuest(Ar, DeltaQuest) == false)
+			{
+				return false;
+			}
+			FCompactQuest* Quest = Quests.FindByPredicate([&](const FCompactQuest& E) { return E.Name == DeltaQuest.Name; });
+			if (DeltaQuest.bFullState)
+			{
+				if (Quest)
+				{
+					*Quest = MoveTemp(DeltaQuest);
+				}
+				else
+				{
+					Quests.Add(MoveTemp(DeltaQuest));
+				}
+				continue;
+			}
+			if (Quest == nullptr || Quest->ClassPath != DeltaQuest.ClassPath)
+			{
+				UE_LOG(LogGameQuest, Warning, TEXT("Quest %s of delta not found in base save"), *DeltaQuest.Name.ToString());
+				return false;
+			}
+			Quest->Header = MoveTemp(DeltaQuest.Header);
+			for (TPair<uint32, FCompactRecord>& Pair : DeltaQuest.Records)
+			{
+				if (Pair.Value.Payload.Num() == 0)
+				{
+					Quest->Records.Remove(Pair.Key);
+				}
+				else
+				{
+					Quest->Records.Add(Pair.Key, MoveTemp(Pair.Value));
+				}
+			}
+		}
+
+		uint32 RecordNum;
+		if (ReadCount(Ar, RecordNum) == false)
+		{
+			return false;
+		}
+		for (uint32 Idx = 0; Idx < RecordNum; ++Idx)
+		{
+			const uint32 RecordGeneration = ReadVarint(Ar);
+			FArchiveRecordData RecordData;
+			SerializeArchiveRecord(Ar, RecordData);
+			if (RecordGeneration > Generation)
+			{
+				ArchivedRecords.Add(MoveTemp(RecordData));
+			}
+		}
+		if (Ar.IsError())
+		{
+			return false;
+		}
+		Generation = DeltaGeneration;
+	}
+
+	FMemoryWriter Ar{ OutData };
+	WriteVarint(Ar, static_cast<uint32>(EVersion::Latest));
+	uint8 SaveKind = static_cast<uint8>(EComponentSave::Full);
+	Ar << SaveKind;
+	WriteVarint(Ar, Generation);
+	WriteVarint(Ar, Quests.Num());
+	for (FCompactQuest& Quest : Quests)
+	{
+		WriteCompactQuest(Ar, Quest);
+	}
+	WriteVarint(Ar, ArchivedRecords.Num());
+	for (FArchiveRecordData& RecordData : ArchivedRecords)
+	{
+		SerializeArchiveRecord(Ar, RecordData);
+	}
+	return true;
+}
@@ -0,0 +1,485 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GameQuestTickManager.h"
+
+#include "GameQuestComponent.h"
+#include "GameQuestElementBase.h"
+#include "GameQuestGraphBase.h"
+#include "GameQuestSequenceBase.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Quest Ticked Nodes"), STAT_GameQuestTickedNodes, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Quest Deferred Nodes"), STAT_GameQuestDeferredNodes, STATGROUP_Game);
+
+TAutoConsoleVariable<float> CVarGameQuestTickBudgetMs
+{
+	TEXT("GameQuest.TickBudgetMs"),
+	0.f,
+	TEXT("Quest element tick budget per frame in milliseconds, over budget element continue next frame, 0 mean no limit")
+};
+
+TAutoConsoleVariable<float> CVarGameQuestSignificanceBaseInterval
+{
+	TEXT("GameQuest.SignificanceBaseInterval"),
+	1.f / 30.f,
+	TEXT("Tick interval of every frame ticking quest node at significance 1, scaled by 1 / significance")
+};
+
+TAutoConsoleVariable<float> CVarGameQuestSignificanceUpdateInterval
+{
+	TEXT("GameQuest.SignificanceUpdateInterval"),
+	0.5f,
+	TEXT("Seconds between evaluate tick significance of quest component")
+};
+
+TAutoConsoleVariable<bool> CVarGameQuestDeferredEvents
+{
+	TEXT("GameQuest.DeferredEvents"),
+	false,
+	TEXT("Queue element finish, unfinish and interrupt then process them in one batch before quest node tick")
+};
+
+TAutoConsoleVariable<int32> CVarGameQuestTickMinPerBucket
+{
+	TEXT("GameQuest.TickMinPerBucket"),
+	1,
+	TEXT("Min ticked element of each tick interval bucket per frame even over budget, avoid starvation")
+};
+
+UGameQuestTickManager* UGameQuestTickManager::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UGameQuestTickManager>() : nullptr;
+}
+
+void UGameQuestTickManager::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Buckets.SetNum(SequenceBucket + 1);
+}
+
+void UGameQuestTickManager::Deinitialize()
+{
+	for (FTickBucket& Bucket : Buckets)
+	{
+		for (const FTickEntry& Entry : Bucket.Entries)
+		{
+			if (Entry.Node && Entry.Quest.IsValid())
+			{
+				Entry.Node->TickBucket = INDEX_NONE;
+				Entry.Node->TickIndex = INDEX_NONE;
+			}
+		}
+	}
+	Buckets.Empty();
+	DeferredEvents.Empty();
+	PendingEventIndices.Empty();
+	Super::Deinitialize();
+}
+
+void UGameQuestTickManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Events from timers and other actors since last tick
+	ProcessDeferredEvents();
+
+	TickTime += DeltaTime;
+	TGuardValue TickingGuard{ bIsTicking, true };
+	const double BudgetSeconds = CVarGameQuestTickBudgetMs.GetValueOnGameThread() / 1000.0;
+	const int32 MinTicksPerBucket = FMath::Max(CVarGameQuestTickMinPerBucket.GetValueOnGameThread(), 1);
+	// Taken when the first budgeted bucket begin, unbudgeted sequence bucket not count in the budget
+	double StartTime = 0.0;
+	const float SignificanceBaseInterval = CVarGameQuestSignificanceBaseInterval.GetValueOnGameThread();
+	LastFrameStats = FTickStats{};
+	// Node tick could add bucket or entry, so always access by index
+	for (int32 BucketIdx = 0; BucketIdx < Buckets.Num(); ++BucketIdx)
+	{
+		const float Interval = Buckets[BucketIdx].Interval;
+		const bool bBudgeted = BudgetSeconds > 0.0 && BucketIdx != SequenceBucket;
+		if (bBudgeted && StartTime == 0.0)
+		{
+			StartTime = FPlatformTime::Seconds();
+		}
+		// Entries added while ticking wait next frame
+		const int32 EntryNum = Buckets[BucketIdx].Entries.Num();
+		const int32 Cursor = Buckets[BucketIdx].Cursor < EntryNum ? Buckets[BucketIdx].Cursor : 0;
+		int32 BucketTickedNum = 0;
+		int32 Visited = 0;
+		for (; Visited < EntryNum; ++Visited)
+		{
+			const int32 Idx = (Cursor + Visited) % EntryNum;
+			FTickEntry& Entry = Buckets[BucketIdx].Entries[Idx];
+			if (Entry.Node == nullptr)
+			{
+				continue;
+			}
+			const UGameQuestGraphBase* Quest = Entry.Quest.Get();
+			if (Quest == nullptr)
+			{
+				RemoveEntryAt(Buckets[BucketIdx].Entries, Idx);
+				continue;
+			}
+			if (Quest->bIsActivated == false)
+			{
+				Entry.LastTickTime = TickTime;
+				continue;
+			}
+			const float Significance = Entry.bIgnoreSignificance ? 1.f : GetSignificance(Entry);
+			if (Significance <= 0.f)
+			{
+				// Paused, resumed entry not get the whole paused time
+				Entry.LastTickTime = TickTime;
+				continue;
+			}
+			const float EffectiveInterval = Significance < 1.f ? (Interval > 0.f ? Interval : SignificanceBaseInterval) / Significance : Interval;
+			// Significance may raise since last schedule
+			if (TickTime < FMath::Min(Entry.NextTickTime, Entry.LastTickTime + EffectiveInterval))
+			{
+				continue;
+			}
+			if (bBudgeted && BucketTickedNum >= MinTicksPerBucket && FPlatformTime::Seconds() - StartTime > BudgetSeconds)
+			{
+				break;
+			}
+			// Deferred entry get the whole elapsed time
+			const float EntryDeltaTime = static_cast<float>(TickTime - Entry.LastTickTime);
+			Entry.LastTickTime = TickTime;
+			Entry.NextTickTime += EffectiveInterval;
+			if (Entry.NextTickTime <= TickTime)
+			{
+				Entry.NextTickTime = TickTime + EffectiveInterval;
+			}
+			BucketTickedNum += 1;
+			FGameQuestNodeBase* Node = Entry.Node;
+			if (BucketIdx == SequenceBucket)
+			{
+				static_cast<FGameQuestSequenceBase*>(Node)->Tick(EntryDeltaTime);
+			}
+			else
+			{
+				static_cast<FGameQuestElementBase*>(Node)->Tick(EntryDeltaTime);
+			}
+		}
+		// Continue from the first unvisited entry next frame
+		Buckets[BucketIdx].Cursor = EntryNum > 0 ? (Cursor + Visited) % EntryNum : 0;
+		for (; Visited < EntryNum; ++Visited)
+		{
+			const FTickEntry& Entry = Buckets[BucketIdx].Entries[(Cursor + Visited) % EntryNum];
+			if (Entry.Node && TickTime >= Entry.NextTickTime)
+			{
+				LastFrameStats.DeferredNum += 1;
+			}
+		}
+		LastFrameStats.TickedNum += BucketTickedNum;
+	}
+	TotalDeferredNum += LastFrameStats.DeferredNum;
+	SET_DWORD_STAT(STAT_GameQuestTickedNodes, LastFrameStats.TickedNum);
+	SET_DWORD_STAT(STAT_GameQuestDeferredNodes, LastFrameStats.DeferredNum);
+	if (LastFrameStats.DeferredNum > 0)
+	{
+		UE_LOG(LogGameQuest, Verbose, TEXT("Quest tick over budget, ticked %d deferred %d"), LastFrameStats.TickedNum, LastFrameStats.DeferredNum);
+	}
+	// Events from node tick not wait next frame, still in ticking so removed entries are compacted below
+	ProcessDeferredEvents();
+	if (bHasPendingRemove)
+	{
+		bHasPendingRemove = false;
+		for (FTickBucket& Bucket : Buckets)
+		{
+			CompactEntries(Bucket.Entries);
+		}
+	}
+
+	// Requests of this frame, include the ones from node tick
+	for (const TWeakObjectPtr<UGameQuestComponent>& Component : PendingRequestComponents)
+	{
+		if (Component.IsValid())
+		{
+			Component->FlushElementRequests();
+		}
+	}
+	PendingRequestComponents.Reset();
+}
+
+void UGameQuestTickManager::AddPendingElementRequests(UGameQuestComponent& Component)
+{
+	PendingRequestComponents.AddUnique(&Component);
+}
+
+float UGameQuestTickManager::GetSignificance(FTickEntry& Entry)
+{
+	UGameQuestComponent* Component = Entry.Component.Get();
+	if (Component == nullptr)
+	{
+		return 1.f;
+	}
+	if (EvaluateSignificance.IsBound() && TickTime >= Component->NextSignificanceUpdateTime)
+	{
+		Component->NextSignificanceUpdateTime = TickTime + CVarGameQuestSignificanceUpdateInterval.GetValueOnGameThread();
+		Component->SetTickSignificance(EvaluateSignificance.Execute(Component));
+	}
+	return Component->TickSignificance;
+}
+
+UGameQuestTickManager* UGameQuestTickManager::GetDeferredEventQueue(const UObject* WorldContextObject)
+{
+	if (CVarGameQuestDeferredEvents.GetValueOnGameThread() == false)
+	{
+		return nullptr;
+	}
+	UGameQuestTickManager* TickManager = Get(WorldContextObject);
+	return TickManager && TickManager->bIsDispatchingEvent == false ? TickManager : nullptr;
+}
+
+void UGameQuestTickManager::EnqueueFinishElement(FGameQuestElementBase& Element, const FGameQuestFinishEvent& FinishEvent)
+{
+	EnqueueEvent(*Element.OwnerQuest, Element.GetNodeId(), EDeferredEvent::Finish, FinishEvent);
+}
+
+void UGameQuestTickManager::EnqueueUnfinishElement(FGameQuestElementBase& Element)
+{
+	EnqueueEvent(*Element.OwnerQuest, Element.GetNodeId(), EDeferredEvent::Unfinish);
+}
+
+void UGameQuestTickManager::EnqueueInterruptSequence(FGameQuestSequenceBase& Sequence)
+{
+	EnqueueEvent(*Sequence.OwnerQuest, Sequence.GetNodeId(), EDeferredEvent::InterruptSequence);
+}
+
+void UGameQuestTickManager::EnqueueInterruptBranch(FGameQuestElementBase& Element)
+{
+	EnqueueEvent(*Element.OwnerQuest, Element.GetNodeId(), EDeferredEvent::InterruptBranch);
+}
+
+void UGameQuestTickManager::EnqueueInterruptQuest(UGameQuestGraphBase& Quest)
+{
+	EnqueueEvent(Quest, GameQuest::IdNone, EDeferredEvent::InterruptQuest);
+}
+
+void UGameQuestTickManager::EnqueueEvent(UGameQuestGraphBase& Quest, uint16 NodeId, EDeferredEvent Type, const FGameQuestFinishEvent& FinishEvent)
+{
+	const TPair<TObjectKey<UGameQuestGraphBase>, uint16> Key{ &Quest, NodeId };
+	if (const int32* PendingIdx = PendingEventIndices.Find(Key))
+	{
+		FDeferredEvent& PendingEvent = DeferredEvents[*PendingIdx];
+		if (PendingEvent.Type == Type)
+		{
+			return;
+		}
+		// Sequence never see the element state changed, cancel in place so indices are kept
+		if ((PendingEvent.Type == EDeferredEvent::Finish && Type == EDeferredEvent::Unfinish) || (PendingEvent.Type == EDeferredEvent::Unfinish && Type == EDeferredEvent::Finish))
+		{
+			PendingEvent.Type = EDeferredEvent::None;
+			PendingEventIndices.Remove(Key);
+			return;
+		}
+	}
+	PendingEventIndices.Add(Key, DeferredEvents.Add({ &Quest, NodeId, Type, FinishEvent }));
+}
+
+void UGameQuestTickManager::ProcessDeferredEvents()
+{
+	if (DeferredEvents.Num() == 0)
+	{
+		return;
+	}
+	TGuardValue DispatchingGuard{ bIsDispatchingEvent, true };
+	const TArray<FDeferredEvent> Events = MoveTemp(DeferredEvents);
+	PendingEventIndices.Reset();
+	for (const FDeferredEvent& Event : Events)
+	{
+		DispatchEvent(Event);
+	}
+}
+
+void UGameQuestTickManager::DispatchEvent(const FDeferredEvent& Event)
+{
+	UGameQuestGraphBase* Quest = Event.Quest.Get();
+	if (Quest == nullptr || Quest->bIsActivated == false)
+	{
+		return;
+	}
+	switch (Event.Type)
+	{
+	case EDeferredEvent::None:
+		break;
+	case EDeferredEvent::Finish:
+	case EDeferredEvent::Unfinish:
+	{
+		FGameQuestElementBase* Element = Quest->GetElementPtr(Event.NodeId);
+		FGameQuestSequenceBase* OwnerSequence = Quest->GetSequencePtr(Element->Sequence);
+		// Element may be deactivated or changed back by the time
+		if (OwnerSequence->bIsActivated == false)
+		{
+			return;
+		}
+		if (Event.Type == EDeferredEvent::Finish)
+		{
+			if (Element->bIsFinished)
+			{
+				OwnerSequence->WhenElementFinished(Element, Event.FinishEvent);
+			}
+		}
+		else if (Element->bIsFinished == false)
+		{
+			OwnerSequence->WhenElementUnfinished(Element);
+		}
+		break;
+	}
+	case EDeferredEvent::InterruptSequence:
+		Quest->InterruptSequence(*Quest->GetSequencePtr(Event.NodeId));
+		break;
+	case EDeferredEvent::InterruptBranch:
+		Quest->InterruptBranch(*Quest->GetElementPtr(Event.NodeId));
+		break;
+	case EDeferredEvent::InterruptQuest:
+		Quest->InterruptQuest();
+		break;
+	}
+}
+
+TStatId UGameQuestTickManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGameQuestTickManager, STATGROUP_Tickables);
+}
+
+bool UGameQuestTickManager::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGameQuestTickManager::RegisterElement(FGameQuestElementBase& Element)
+{
+	RegisterEntry(FindOrAddBucket(Element.GetTickInterval()), Element, Element.GetTickPhase(), Element.IsTickSignificanceIgnored());
+}
+
+void UGameQuestTickManager::UnregisterElement(FGameQuestElementBase& Element)
+{
+	UnregisterEntry(Element);
+}
+
+void UGameQuestTickManager::RegisterSequence(FGameQuestSequenceBase& Sequence)
+{
+	RegisterEntry(SequenceBucket, Sequence, 0.f, false);
+}
+
+void UGameQuestTickManager::UnregisterSequence(FGameQuestSequenceBase& Sequence)
+{
+	UnregisterEntry(Sequence);
+}
+
+void UGameQuestTickManager::UnregisterComponent(const UGameQuestComponent* Component)
+{
+	for (FTickBucket& Bucket : Buckets)
+	{
+		for (int32 Idx = Bucket.Entries.Num() - 1; Idx >= 0; --Idx)
+		{
+			const FTickEntry& Entry = Bucket.Entries[Idx];
+			if (Entry.Node && Entry.Component == Component)
+			{
+				if (Entry.Quest.IsValid())
+				{
+					Entry.Node->TickBucket = INDEX_NONE;
+					Entry.Node->TickIndex = INDEX_NONE;
+				}
+				RemoveEntryAt(Bucket.Entries, Idx);
+			}
+		}
+	}
+}
+
+int32 UGameQuestTickManager::FindOrAddBucket(float Interval)
+{
+	Interval = FMath::Max(Interval, 0.f);
+	for (int32 Idx = SequenceBucket + 1; Idx < Buckets.Num(); ++Idx)
+	{
+		if (Buckets[Idx].Interval == Interval)
+		{
+			return Idx;
+		}
+	}
+	FTickBucket& Bucket = Buckets.AddDefaulted_GetRef();
+	Bucket.Interval = Interval;
+	return Buckets.Num() - 1;
+}
+
+void UGameQuestTickManager::RegisterEntry(int32 BucketIndex, FGameQuestNodeBase& Node, float Phase, bool bIgnoreSignificance)
+{
+	if (!ensure(Node.TickIndex == INDEX_NONE))
+	{
+		return;
+	}
+	FTickBucket& Bucket = Buckets[BucketIndex];
+	double NextTickTime = TickTime;
+	if (Bucket.Interval > 0.f)
+	{
+		if (Phase < 0.f)
+		{
+			// Golden ratio sequence keep phases evenly spread whatever the element count is
+			constexpr double GoldenRatioConjugate = 0.6180339887498949;
+			Phase = static_cast<float>(FMath::Frac(Bucket.StaggerCounter++ * GoldenRatioConjugate));
+		}
+		NextTickTime += Bucket.Interval * FMath::Clamp(Phase, 0.f, 1.f);
+	}
+	UGameQuestGraphBase* MainQuest;
+	UGameQuestComponent* Component = Node.OwnerQuest->GetComponent(MainQuest);
+	Node.TickBucket = BucketIndex;
+	Node.TickIndex = Bucket.Entries.Add({ Node.OwnerQuest.Get(), Component, &Node, TickTime, NextTickTime, bIgnoreSignificance });
+}
+
+void UGameQuestTickManager::UnregisterEntry(FGameQuestNodeBase& Node)
+{
+	const int32 BucketIndex = Node.TickBucket;
+	const int32 Index = Node.TickIndex;
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+	Node.TickBucket = INDEX_NONE;
+	Node.TickIndex = INDEX_NONE;
+	if (!ensure(Buckets.IsValidIndex(BucketIndex)))
+	{
+		return;
+	}
+	TArray<FTickEntry>& Entries = Buckets[BucketIndex].Entries;
+	if (ensure(Entries.IsValidIndex(Index) && Entries[Index].Node == &Node))
+	{
+		RemoveEntryAt(Entries, Index);
+	}
+}
+
+void UGameQuestTickManager::RemoveEntryAt(TArray<FTickEntry>& Entries, int32 Index)
+{
+	// Swap remove while ticking would skip the moved entry, so only clear it and compact after tick
+	if (bIsTicking)
+	{
+		Entries[Index].Node = nullptr;
+		bHasPendingRemove = true;
+		return;
+	}
+	Entries.RemoveAtSwap(Index, 1, false);
+	if (Entries.IsValidIndex(Index) && Entries[Index].Node && Entries[Index].Quest.IsValid())
+	{
+		Entries[Index].Node->TickIndex = Index;
+	}
+}
+
+void UGameQuestTickManager::CompactEntries(TArray<FTickEntry>& Entries)
+{
+	for (int32 Idx = Entries.Num() - 1; Idx >= 0; --Idx)
+	{
+		if (Entries[Idx].Node)
+		{
+			continue;
+		}
+		Entries.RemoveAtSwap(Idx, 1, false);
+		if (Entries.IsValidIndex(Idx) && Entries[Idx].Quest.IsValid())
+		{
+			Entries[Idx].Node->TickIndex = Idx;
+		}
+	}
+}
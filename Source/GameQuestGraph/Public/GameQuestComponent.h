@@ -5,9 +5,185 @@
 #include "CoreMinimal.h"
 #include "GameQuestType.h"
 #include "Components/ActorComponent.h"
+#include "Net/Serialization/FastArraySerializer.h"
 #include "GameQuestComponent.generated.h"
 
 class UGameQuestGraphBase;
+class UGameQuestComponent;
+struct FGameQuestArchiveRecords;
+struct FGameQuestList;
+struct FGameQuestSummaryList;
+
+USTRUCT()
+struct GAMEQUESTGRAPH_API FGameQuestListItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	TObjectPtr<UGameQuestGraphBase> Quest;
+
+	void PostReplicatedAdd(const FGameQuestList& InArraySerializer);
+	// Quest object may be resolved after the item added
+	void PostReplicatedChange(const FGameQuestList& InArraySerializer);
+	void PreReplicatedRemove(const FGameQuestList& InArraySerializer);
+};
+
+// Delta replicated quest list, client callback keep the component quest array in sync
+USTRUCT()
+struct GAMEQUESTGRAPH_API FGameQuestList : public FFastArraySerializer
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	TArray<FGameQuestListItem> Items;
+	UGameQuestComponent* Owner = nullptr;
+	// Class only list kept in sync, replicated to connections out of quest detail scope
+	FGameQuestSummaryList* Summary = nullptr;
+	bool bFinishedList = false;
+
+	void AddQuest(UGameQuestGraphBase* Quest);
+	void RemoveQuest(UGameQuestGraphBase* Quest);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FGameQuestListItem, FGameQuestList>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FGameQuestList> : public TStructOpsTypeTraitsBase2<FGameQuestList>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+USTRUCT()
+struct GAMEQUESTGRAPH_API FGameQuestSummaryItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	TSubclassOf<UGameQuestGraphBase> QuestClass;
+};
+
+// Summary of quest list, no quest object reference so connection out of replication scope can receive it
+USTRUCT()
+struct GAMEQUESTGRAPH_API FGameQuestSummaryList : public FFastArraySerializer
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	TArray<FGameQuestSummaryItem> Items;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FGameQuestSummaryItem, FGameQuestSummaryList>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FGameQuestSummaryList> : public TStructOpsTypeTraitsBase2<FGameQuestSummaryList>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+USTRUCT()
+struct GAMEQUESTGRAPH_API FGameQuestElementRequest
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	uint16 ElementId = GameQuest::IdNone;
+	// FGameQuestElementBase::GetFinishEventIndex, unused by unfinish
+	UPROPERTY()
+	uint8 EventIndex = 0;
+	UPROPERTY()
+	bool bFinish = true;
+};
+
+USTRUCT()
+struct GAMEQUESTGRAPH_API FGameQuestElementRequestBatch
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	TObjectPtr<UGameQuestGraphBase> Quest;
+	UPROPERTY()
+	TArray<FGameQuestElementRequest> Requests;
+};
+
+UENUM(BlueprintType)
+enum class EGameQuestReplicationScope : uint8
+{
+	// Quest detail replicate to all relevant connections
+	Everyone,
+	// Quest detail and quest lists only replicate to owner
+	OwnerOnly,
+	// Quest detail replicate to connections in replication group, others only get the quest list summary
+	Team,
+	// Quest detail replicate to owner, others only get the quest list summary
+	OwnerDetailOthersSummary,
+};
+
+UENUM(BlueprintType)
+enum class EGameQuestArchiveResult : uint8
+{
+	Finished,
+	Interrupted,
+};
+
+// Finished quest collapsed to record, quest object is released
+USTRUCT(BlueprintType)
+struct GAMEQUESTGRAPH_API FGameQuestArchiveRecord : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, SaveGame, Category = "GameQuest")
+	TSubclassOf<UGameQuestGraphBase> QuestClass;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, SaveGame, Category = "GameQuest")
+	EGameQuestArchiveResult Result = EGameQuestArchiveResult::Finished;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, SaveGame, Category = "GameQuest")
+	FName FinishedRerouteTag;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, SaveGame, Category = "GameQuest")
+	FDateTime FinishedTime;
+	// Finished sequence ids from start sequences, only recorded when bArchiveQuestPath
+	UPROPERTY(SaveGame)
+	TArray<uint16> Path;
+	// Component save generation the record added, used by delta save
+	uint32 SaveGeneration = 0;
+
+	void PostReplicatedAdd(const FGameQuestArchiveRecords& InArraySerializer);
+	void PreReplicatedRemove(const FGameQuestArchiveRecords& InArraySerializer);
+};
+
+USTRUCT()
+struct GAMEQUESTGRAPH_API FGameQuestArchiveRecords : public FFastArraySerializer
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(SaveGame)
+	TArray<FGameQuestArchiveRecord> Items;
+	UGameQuestComponent* Owner = nullptr;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FGameQuestArchiveRecord, FGameQuestArchiveRecords>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FGameQuestArchiveRecords> : public TStructOpsTypeTraitsBase2<FGameQuestArchiveRecords>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
 
 UCLASS(ClassGroup=(Game), meta=(BlueprintSpawnableComponent))
 class GAMEQUESTGRAPH_API UGameQuestComponent : public UActorComponent
@@ -15,29 +191,103 @@ class GAMEQUESTGRAPH_API UGameQuestComponent : public UActorComponent
 	GENERATED_BODY()
 
 	friend UGameQuestGraphBase;
+	friend class UGameQuestTickManager;
 public:
 	UGameQuestComponent();
 
-	void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	void PostInitProperties() override;
+	void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	void Activate(bool bReset) override;
 	void Deactivate() override;
 	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	void ReadyForReplication() override;
 	bool ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
 
-	TSet<TObjectPtr<UGameQuestGraphBase>> PreActivatedQuests;
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "GameQuest", ReplicatedUsing = OnRep_ActivatedQuests)
+	// Who receive quest objects, their node properties and subobjects
+	UPROPERTY(EditAnywhere, Category = "Replication")
+	EGameQuestReplicationScope ReplicationScope = EGameQuestReplicationScope::Everyone;
+	// Net condition group of Team scope, include player controller to it by APlayerController::IncludeInNetConditionGroup
+	UPROPERTY(EditAnywhere, Category = "Replication", meta = (EditCondition = "ReplicationScope == EGameQuestReplicationScope::Team"))
+	FName ReplicationGroup;
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "GameQuest")
+	void SetReplicationScope(EGameQuestReplicationScope Scope, FName Group = NAME_None);
+	// Client activate next sequence of finished local judgment element before server confirm, rollback when server state differ
+	UPROPERTY(EditAnywhere, Category = "Replication")
+	bool bPredictLocalJudgment = false;
+
+	// Quest classes of list, valid on connection out of replication scope too
+	UFUNCTION(BlueprintCallable, Category = "GameQuest")
+	TArray<TSubclassOf<UGameQuestGraphBase>> GetActivatedQuestSummary() const;
+	UFUNCTION(BlueprintCallable, Category = "GameQuest")
+	TArray<TSubclassOf<UGameQuestGraphBase>> GetFinishedQuestSummary() const;
+
+	// Replicated by quest list, on client it is updated by the list callback
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "GameQuest")
 	TArray<TObjectPtr<UGameQuestGraphBase>> ActivatedQuests;
-	UFUNCTION()
-	void OnRep_ActivatedQuests();
+	UPROPERTY(Replicated)
+	FGameQuestList ActivatedQuestList;
+	UPROPERTY(Replicated)
+	FGameQuestSummaryList ActivatedQuestSummary;
 
-	TSet<TObjectPtr<UGameQuestGraphBase>> PreFinishedQuests;
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "GameQuest", ReplicatedUsing = OnRep_FinishedQuests)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "GameQuest")
 	TArray<TObjectPtr<UGameQuestGraphBase>> FinishedQuests;
-	UFUNCTION()
-	void OnRep_FinishedQuests();
+	UPROPERTY(Replicated)
+	FGameQuestList FinishedQuestList;
+	UPROPERTY(Replicated)
+	FGameQuestSummaryList FinishedQuestSummary;
+
+	// Collapse finished quest to archive record instead of keeping it in FinishedQuests
+	UPROPERTY(EditAnywhere, Category = "GameQuest")
+	bool bArchiveFinishedQuests = false;
+	UPROPERTY(EditAnywhere, Category = "GameQuest", meta = (EditCondition = bArchiveFinishedQuests))
+	bool bArchiveQuestPath = false;
+	UPROPERTY(VisibleAnywhere, Replicated, Category = "GameQuest")
+	FGameQuestArchiveRecords ArchivedQuests;
+	const TArray<FGameQuestArchiveRecord>& GetArchivedQuests() const { return ArchivedQuests.Items; }
+
+	// Scale tick rate of quest nodes, 1 is full rate, lower tick less often, 0 pause ticking
+	UFUNCTION(BlueprintCallable, Category = "GameQuest")
+	void SetTickSignificance(float Significance) { TickSignificance = FMath::Clamp(Significance, 0.f, 1.f); }
+	UFUNCTION(BlueprintCallable, Category = "GameQuest")
+	float GetTickSignificance() const { return TickSignificance; }
 private:
+	float TickSignificance = 1.f;
+	double NextSignificanceUpdateTime = 0.0;
+
 	void PostStartQuest(UGameQuestGraphBase* StartedQuest);
 	void PostFinishQuest(UGameQuestGraphBase* FinishedQuest);
+	void ArchiveQuest(UGameQuestGraphBase* FinishedQuest);
+	friend FGameQuestArchiveRecord;
+	friend FGameQuestListItem;
+	friend struct FGameQuestStateSerializer;
+	// Increased by each quest state save, changes are marked with it
+	uint32 SaveGeneration = 1;
+	// Delta save can only base on generation not older than last full save, removed quests before it are forgot
+	uint32 FullSaveGeneration = 0;
+	struct FRemovedQuestSave
+	{
+		FName Name;
+		uint32 Generation = 0;
+	};
+	TArray<FRemovedQuestSave> RemovedQuestSaves;
+	// Loaded state is already in the loaded generation, don't stamp it by the load and reactivation
+	bool bSuppressSaveStateDirty = false;
+	void WhenQuestListItemAdded(const FGameQuestList& List, UGameQuestGraphBase* Quest);
+	void WhenQuestListItemRemoved(const FGameQuestList& List, UGameQuestGraphBase* Quest);
+
+	ELifetimeCondition GetQuestNetCondition() const;
+	void UpdateReplicationConditions();
+	void AddReplicatedQuestSubObject(UObject* SubObject);
+	void RemoveReplicatedQuestSubObject(UObject* SubObject);
+
+	// Client finish requests of local judgment elements, sent by one reliable RPC at the end of quest tick
+	friend struct FGameQuestElementBase;
+	TArray<FGameQuestElementRequestBatch> PendingElementRequests;
+	// Return false when caller should send the immediate RPC, pending requests are flushed before it
+	bool EnqueueElementRequest(UGameQuestGraphBase& Quest, uint16 ElementId, bool bFinish, uint8 EventIndex);
+	void FlushElementRequests();
+	UFUNCTION(Server, Reliable)
+	void ApplyElementRequestsToServer(const TArray<FGameQuestElementRequestBatch>& Batches);
 protected:
 	virtual void WhenQuestStarted(UGameQuestGraphBase* FinishedQuest) {}
 	virtual void WhenQuestFinished(UGameQuestGraphBase* FinishedQuest) {}
@@ -46,6 +296,8 @@ protected:
 	virtual void WhenQuestDeactivated(UGameQuestGraphBase* Quest) { OnQuestDeactivated.Broadcast(this, Quest); }
 	virtual void WhenFinishedQuestAdded(UGameQuestGraphBase* Quest) { OnFinishedQuestAdded.Broadcast(this, Quest); }
 	virtual void WhenFinishedQuestRemoved(UGameQuestGraphBase* Quest) { OnFinishedQuestRemoved.Broadcast(this, Quest); }
+	virtual void WhenArchivedQuestAdded(const FGameQuestArchiveRecord& Record) { OnArchivedQuestAdded.Broadcast(this, Record); }
+	virtual void WhenArchivedQuestRemoved(const FGameQuestArchiveRecord& Record) { OnArchivedQuestRemoved.Broadcast(this, Record); }
 
 	virtual void WhenPreSequenceActivated(UGameQuestGraphBase* MainQuest, UGameQuestGraphBase* OwnerQuest, FGameQuestSequenceBase* Sequence) { OnPreSequenceActivated.Broadcast(this, MainQuest, OwnerQuest, FGameQuestSequencePtr{ *Sequence }); }
 	virtual void WhenPostSequenceDeactivated(UGameQuestGraphBase* MainQuest, UGameQuestGraphBase* OwnerQuest, FGameQuestSequenceBase* Sequence) { OnPostSequenceDeactivated.Broadcast(this, MainQuest, OwnerQuest, FGameQuestSequencePtr{ *Sequence }); }
@@ -67,6 +319,12 @@ public:
 	DECLARE_DYNAMIC_MULTICAST_SPARSE_DELEGATE_TwoParams(FOnFinishedQuestRemoved, UGameQuestComponent, OnFinishedQuestRemoved, UGameQuestComponent*, QuestComponent, UGameQuestGraphBase*, Quest);
 	UPROPERTY(BlueprintAssignable, Transient, Category = "GameQuest")
 	FOnFinishedQuestRemoved OnFinishedQuestRemoved;
+	DECLARE_DYNAMIC_MULTICAST_SPARSE_DELEGATE_TwoParams(FOnArchivedQuestAdded, UGameQuestComponent, OnArchivedQuestAdded, UGameQuestComponent*, QuestComponent, const FGameQuestArchiveRecord&, Record);
+	UPROPERTY(BlueprintAssignable, Transient, Category = "GameQuest")
+	FOnArchivedQuestAdded OnArchivedQuestAdded;
+	DECLARE_DYNAMIC_MULTICAST_SPARSE_DELEGATE_TwoParams(FOnArchivedQuestRemoved, UGameQuestComponent, OnArchivedQuestRemoved, UGameQuestComponent*, QuestComponent, const FGameQuestArchiveRecord&, Record);
+	UPROPERTY(BlueprintAssignable, Transient, Category = "GameQuest")
+	FOnArchivedQuestRemoved OnArchivedQuestRemoved;
 
 	DECLARE_DYNAMIC_MULTICAST_SPARSE_DELEGATE_FourParams(FOnPreSequenceActivated, UGameQuestComponent, OnPreSequenceActivated, UGameQuestComponent*, QuestComponent, UGameQuestGraphBase*, MainQuest, UGameQuestGraphBase*, OwnerQuest, const FGameQuestSequencePtr&, Sequence);
 	UPROPERTY(BlueprintAssignable, Transient, Category = "GameQuest")
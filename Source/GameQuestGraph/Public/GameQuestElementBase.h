@@ -37,12 +37,18 @@ public:
 	uint8 bIsFinished : 1;
 	bool IsInterrupted() const;
 
-	void WhenQuestInitProperties(const FStructProperty* Property) override;
+	void BuildQuestInitDesc(FGameQuestNodeInitDesc& Desc, const UClass* QuestClass) const override;
 	void WhenOnRepValue(const FGameQuestNodeBase& PreValue) override;
 
 	virtual bool IsJudgmentBothSide() const { return false; }
 	virtual bool IsLocalJudgment() const { return false; }
 	virtual bool IsTickable() const { return false; }
+	// seconds between tick, 0 mean tick every frame
+	virtual float GetTickInterval() const { return 0.f; }
+	// first tick offset in [0, 1) of interval, negative mean staggered by tick manager
+	virtual float GetTickPhase() const { return -1.f; }
+	// true mean always tick at full rate whatever the component tick significance is
+	virtual bool IsTickSignificanceIgnored() const { return false; }
 #if WITH_EDITOR
 	virtual TSubclassOf<UGameQuestGraphBase> GetSupportQuestGraph() const;
 #endif
@@ -64,6 +70,12 @@ public:
 	void FinishElement(const FGameQuestFinishEvent& OnElementFinishedEvent, const FName& EventName);
 	void UnfinishedElement();
 	virtual void FinishElementByName(const FName& EventName);
+
+	// Index of finish event property in node struct, sent to server instead of event name
+	static constexpr uint8 NoneFinishEventIndex = MAX_uint8 - 1;
+	static constexpr uint8 InvalidFinishEventIndex = MAX_uint8;
+	uint8 GetFinishEventIndex(const FName& EventName) const;
+	bool GetFinishEventName(uint8 EventIndex, FName& EventName) const;
 protected:
 	void ForceFinishElement(const FName& EventName);
 	virtual void WhenForceFinishElement(const FName& EventName);
@@ -120,12 +132,24 @@ protected:
 	UWorld* GetWorld() const override;
 	bool IsSupportedForNetworking() const override { return true; }
 	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+#if UE_WITH_IRIS
+	void RegisterReplicationFragments(UE::Net::FFragmentRegistrationContext& Context, UE::Net::EFragmentRegistrationFlags RegistrationFlags) override;
+#endif
 	int32 GetFunctionCallspace(UFunction* Function, FFrame* Stack) override;
 	bool CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack) override;
 	void GetAssetRegistryTags(TArray<FAssetRegistryTag>& OutTags) const override;
 
 	UPROPERTY(EditDefaultsOnly, Transient, Category = "Settings")
 	uint8 bTickable : 1;
+	// seconds between tick, 0 mean tick every frame
+	UPROPERTY(EditDefaultsOnly, Transient, Category = "Settings", meta = (EditCondition = bTickable, ClampMin = 0))
+	float TickInterval;
+	// first tick offset in [0, 1) of interval, negative mean staggered by tick manager
+	UPROPERTY(EditDefaultsOnly, Transient, Category = "Settings", meta = (EditCondition = bTickable, UIMax = 1))
+	float TickPhase;
+	// true mean always tick at full rate whatever the component tick significance is
+	UPROPERTY(EditDefaultsOnly, Transient, Category = "Settings", meta = (EditCondition = bTickable))
+	uint8 bIgnoreTickSignificance : 1;
 	// false mean server check
 	// true mean local player check
 	UPROPERTY(EditDefaultsOnly, Transient, Category = "Settings")
@@ -174,11 +198,16 @@ public:
 	UPROPERTY(BlueprintReadWrite, SaveGame, Instanced, NotReplicated, Category = "GameQuest")
 	TObjectPtr<UGameQuestElementScriptable> Instance;
 
-	void WhenQuestInitProperties(const FStructProperty* Property) override;
+	void BuildQuestInitDesc(FGameQuestNodeInitDesc& Desc, const UClass* QuestClass) const override;
+	void WhenQuestInitProperties(const FGameQuestNodeInitDesc& Desc) override;
 	bool IsLocalJudgment() const override { return Instance ? Instance->bLocalJudgment : false; }
 	bool IsTickable() const override { return Instance ? Instance->bTickable : false; }
+	float GetTickInterval() const override { return Instance ? Instance->TickInterval : 0.f; }
+	float GetTickPhase() const override { return Instance ? Instance->TickPhase : -1.f; }
+	bool IsTickSignificanceIgnored() const override { return Instance ? Instance->bIgnoreTickSignificance : false; }
 	bool ShouldReplicatedSubobject() const override { return true; }
 	bool ReplicateSubobject(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
+	UObject* GetReplicatedSubobject() const override { return Instance; }
 
 	void WhenElementActivated() override { if (ensure(Instance)) Instance->WhenElementActivated(); }
 	void WhenElementDeactivated() override { if (ensure(Instance)) Instance->WhenElementDeactivated(); }
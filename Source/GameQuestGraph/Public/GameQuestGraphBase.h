@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameQuestType.h"
+#include "Engine/TimerHandle.h"
 #include "UObject/Object.h"
 #include "GameQuestGraphBase.generated.h"
 
@@ -13,6 +14,40 @@ struct FGameQuestSequenceBase;
 struct FGameQuestSequenceBranch;
 struct FGameQuestSequenceSubQuest;
 struct FGameQuestElementBase;
+struct FNetDeltaSerializeInfo;
+
+// Flat runtime state of quest, flag bits and successor id slots in compact state layout order
+struct GAMEQUESTGRAPH_API FGameQuestCompactStateData
+{
+	TBitArray<> Flags;
+	TArray<TArray<uint16>> Slots;
+};
+
+// Optional replicated state block replace the node property replication, enabled by GameQuest.CompactReplication
+USTRUCT()
+struct GAMEQUESTGRAPH_API FGameQuestCompactState
+{
+	GENERATED_BODY()
+public:
+	UGameQuestGraphBase* Owner = nullptr;
+	// Increased when quest runtime state changed, base state with same key send nothing
+	uint32 StateKey = 0;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+private:
+	// Server: state gathered at DataKey, shared by connections. Client: last received state
+	TSharedPtr<FGameQuestCompactStateData> Data;
+	uint32 DataKey = MAX_uint32;
+};
+
+template<>
+struct TStructOpsTypeTraits<FGameQuestCompactState> : public TStructOpsTypeTraitsBase2<FGameQuestCompactState>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
 
 UCLASS(Abstract, BlueprintType)
 class GAMEQUESTGRAPH_API UGameQuestGraphBase : public UObject
@@ -24,37 +59,94 @@ class GAMEQUESTGRAPH_API UGameQuestGraphBase : public UObject
 	friend FGameQuestSequenceBranch;
 	friend FGameQuestSequenceSubQuest;
 	friend FGameQuestElementBase;
+	friend class UGameQuestTickManager;
+	friend struct FGameQuestSuccessorSink;
+	friend FGameQuestNodeBase;
+	friend FGameQuestCompactState;
+	friend struct FGameQuestStateSerializer;
 public:
 	void PostInitProperties() override;
+	void PostLoad() override;
+	void Serialize(FArchive& Ar) override;
 	UWorld* GetWorld() const override;
 	bool IsSupportedForNetworking() const override { return true; }
 	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+#if UE_WITH_IRIS
+	void RegisterReplicationFragments(UE::Net::FFragmentRegistrationContext& Context, UE::Net::EFragmentRegistrationFlags RegistrationFlags) override;
+#endif
 	int32 GetFunctionCallspace(UFunction* Function, FFrame* Stack) override;
 	bool CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack) override;
+	// Legacy replication path, Iris replicate quest and node subobjects by the component registered subobject list
 	virtual bool ReplicateSubobject(class UActorChannel* Channel, class FOutBunch* Bunch, struct FReplicationFlags* RepFlags);
 private:
 	uint8 bIsActivated : 1;
 	UPROPERTY(Replicated, SaveGame)
 	uint8 bInterrupted : 1;
 
-	UPROPERTY(Replicated, SaveGame)
+	UPROPERTY(ReplicatedUsing = OnRep_StartSequences, SaveGame)
 	TArray<uint16> StartSequences;
+	UFUNCTION()
+	void OnRep_StartSequences();
+	void RefreshSequenceStates();
 
-	TSet<uint16> PreActivatedSequences;
 	UPROPERTY(ReplicatedUsing = OnRep_ActivatedSequences, SaveGame)
 	TArray<uint16> ActivatedSequences;
 	UFUNCTION()
 	void OnRep_ActivatedSequences();
 
-	TSet<uint16> PreActivatedBranches;
 	UPROPERTY(ReplicatedUsing = OnRep_ActivatedBranches)
 	TArray<uint16> ActivatedBranches;
 	UFUNCTION()
 	void OnRep_ActivatedBranches();
 
-	void Tick(float DeltaSeconds);
-	TArray<FGameQuestElementBase*, TInlineAllocator<4>> TickableElements;
-	TArray<FGameQuestSequenceBase*, TInlineAllocator<4>> TickableSequences;
+	// Bit per node id mirror of activated arrays, on client it is the state of last OnRep
+	TBitArray<> ActivatedSequenceBits;
+	TBitArray<> ActivatedBranchBits;
+	bool IsSequenceIdActivated(uint16 Id) const { return ActivatedSequenceBits.IsValidIndex(Id) && ActivatedSequenceBits[Id]; }
+	bool IsBranchIdActivated(uint16 Id) const { return ActivatedBranchBits.IsValidIndex(Id) && ActivatedBranchBits[Id]; }
+	static void SetActivatedBit(TBitArray<>& Bits, uint16 Id, bool bValue);
+	static TBitArray<> UpdateActivatedBits(TBitArray<>& Bits, const TArray<uint16>& Ids);
+
+	// Client predicted transition of finished local judgment element, overlay replicated activated sequences until server processed the finish
+	struct FSequencePrediction
+	{
+		uint16 FromSequence = GameQuest::IdNone;
+		uint16 ToSequence = GameQuest::IdNone;
+		uint16 Element = GameQuest::IdNone;
+		FTimerHandle TimeoutHandle;
+	};
+	FSequencePrediction SequencePrediction;
+	bool PredictElementFinished(const FGameQuestElementBase& Element, const FName& EventName);
+	void ClearSequencePrediction();
+	void WhenSequencePredictionTimeout();
+
+	// Finished element bits of each element list, only used by authority
+	TArray<uint64> ListFinishedMasks;
+	bool bListFinishedMasksDirty = true;
+	bool bUseListFinishedMasks = false;
+	bool PrepareListFinishedMasks();
+	void SetElementFinishedBit(uint16 ElementId, bool bFinished);
+	bool CanFinishListByMask(uint16 ListId, bool& bCanFinish);
+
+	// Only the root quest's context is used, sub quest transition share it
+	FGameQuestExecutionContext ExecutionContext;
+	FGameQuestExecutionContext& GetExecutionContext();
+	void RebuildActivatedBits();
+
+	UPROPERTY(Replicated, Transient)
+	FGameQuestCompactState CompactState;
+	void MarkCompactStateDirty() { CompactState.StateKey += 1; }
+	void GatherCompactState(FGameQuestCompactStateData& Data) const;
+	void ApplyCompactState(const FGameQuestCompactStateData* PreData, const FGameQuestCompactStateData& Data);
+	static bool IsCoveredByCompactState(const UScriptStruct* NodeStruct);
+	static bool IsUsingIrisReplication();
+
+	// Component save generation of the last change, delta save only write changed quests and node records
+	uint32 SaveGeneration = 0;
+	// Save generation the quest added to component, quest added after delta base is written in full
+	uint32 FullSaveGeneration = 0;
+	TArray<uint32> NodeSaveGenerations;
+	uint32 GetNodeSaveGeneration(uint16 NodeId) const { return NodeSaveGenerations.IsValidIndex(NodeId) ? NodeSaveGenerations[NodeId] : 0; }
 
 	UFUNCTION(Server, Reliable)
 	void SetElementFinishedToServer(const uint16 ElementId, const FName& EventName);
@@ -76,12 +168,19 @@ protected:
 public:
 	virtual FGameQuestSequenceBase* GetSequencePtr(uint16 Id) const;
 	virtual FGameQuestElementBase* GetElementPtr(uint16 Id) const;
+	// Null when id is not an element, use it for id from client
+	FGameQuestElementBase* FindElementPtr(uint16 Id) const;
 	virtual const GameQuest::FLogicList& GetLogicList(const FGameQuestNodeBase* Node) const;
 	virtual uint16 GetSequenceId(const FGameQuestSequenceBase* Sequence) const;
 	virtual uint16 GetElementId(const FGameQuestElementBase* Element) const;
 	virtual TArray<FName> GetRerouteTagNames() const;
 	virtual const FGameQuestRerouteTag* GetRerouteTag(const FName& Name) const;
 	virtual void BindingRerouteTags();
+	// Called by state change, call it after changed custom SaveGame variable of quest so delta save contains it
+	UFUNCTION(BlueprintCallable, Category = "GameQuest")
+	void MarkSaveStateDirty() { MarkNodeSaveStateDirty(GameQuest::IdNone); }
+	// Same for custom SaveGame variable of node
+	void MarkNodeSaveStateDirty(uint16 NodeId);
 
 	UFUNCTION(BlueprintCallable, Category = "GameQuest")
 	UObject* GetOwner() const { return Owner; }
@@ -170,6 +269,12 @@ private:
 	void InvokeInterruptQuest();
 
 	TArray<FGameQuestNodeBase*> ReplicateSubobjectNodes;
+	void AddReplicateSubobjectNode(FGameQuestNodeBase* Node);
+	void RegisterReplicatedSubObject(UObject* SubObject);
+public:
+	// Used when owner component replicate using registered subobject list, include node subobjects and sub quests
+	void RegisterReplicatedSubObjects(UGameQuestComponent& Component);
+	void UnregisterReplicatedSubObjects(UGameQuestComponent& Component);
 public:
 	UFUNCTION(BlueprintCallable, Category = "GameQuest")
 	bool HasAuthority() const;
@@ -3,10 +3,12 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GameQuestNodeBase.h"
 #include "GameQuestType.h"
 #include "Engine/Blueprint.h"
 #include "Engine/BlueprintGeneratedClass.h"
 #include "UObject/Package.h"
+#include <atomic>
 #include "GameQuestGraphBlueprint.generated.h"
 
 UCLASS()
@@ -36,11 +38,93 @@ public:
 	void Serialize(FArchive& Ar) override;
 
 	void PostQuestCDOInitProperties();
+	// Per class tables below are built once from the loaded default object, or the first quest instance when class is just compiled
+	// Gameplay, replication and save only read them, so quest can be used from other threads
+	void ConditionalBuildRuntimeTables(const UGameQuestGraphBase& Quest);
+	bool IsRuntimeTablesBuilt() const { return bRuntimeTablesBuilt; }
 
 	UPROPERTY()
 	TMap<FName, uint16> NodeNameIdMap;
 	TMap<uint16, GameQuest::FLogicList> NodeIdLogicsMap;
 	TMap<uint16, FStructProperty*> NodeIdPropertyMap;
+	// Built from default object, quest instance init nodes by walk it
+	TArray<FGameQuestNodeInitDesc> NodeInitDescs;
+
+	enum class ENodeKind : uint8
+	{
+		None,
+		Sequence,
+		Element,
+	};
+	struct FNodeEntry
+	{
+		int32 Offset = INDEX_NONE;
+		ENodeKind Kind = ENodeKind::None;
+	};
+	// Dense id -> node table, id resolve to node by one index and one pointer add
+	TArray<FNodeEntry> NodeTable;
+	template<typename T>
+	T* GetNodePtr(const UObject* Quest, uint16 Id, ENodeKind Kind) const
+	{
+		const FNodeEntry& Entry = NodeTable[Id];
+		check(Entry.Kind == Kind);
+		return reinterpret_cast<T*>(reinterpret_cast<uint8*>(const_cast<UObject*>(Quest)) + Entry.Offset);
+	}
+
+	// And/Or logic of element list compiled to group masks, finished when finished mask cover any group
+	struct FListLogicMask
+	{
+		TArray<uint64, TInlineAllocator<2>> GroupMasks;
+	};
+	struct FElementListBit
+	{
+		int32 Slot = INDEX_NONE;
+		uint8 Bit = 0;
+	};
+	// List longer than 64 elements has no slot
+	TArray<FListLogicMask> ListLogicMasks;
+	TArray<int32> NodeIdListSlots;
+	TArray<FElementListBit> ElementListBits;
+	void BuildListLogicMasks(const UGameQuestGraphBase& Quest);
+
+	// Element id -> role in sequence branch
+	TArray<GameQuest::FBranchElementRole> BranchElementRoles;
+	void BuildBranchElementRoles(const UGameQuestGraphBase& Quest);
+
+	// Flag and successor slot order of compact replicated state
+	struct FCompactStateLayout
+	{
+		enum class ESequenceKind : uint8
+		{
+			Other,
+			Single,
+			List,
+			Branch,
+		};
+		struct FSequence
+		{
+			uint16 Id = GameQuest::IdNone;
+			ESequenceKind Kind = ESequenceKind::Other;
+			int32 BranchNum = 0;
+		};
+		TArray<uint16> Elements;
+		TArray<FSequence> Sequences;
+		int32 FlagNum = 0;
+		int32 SlotNum = 0;
+	};
+	FCompactStateLayout CompactStateLayout;
+	void BuildCompactStateLayout(const UGameQuestGraphBase& Quest);
+
+	// SaveGame state not covered by quest state serializer
+	struct FSaveStateLayout
+	{
+		TArray<const FProperty*> ExtraProperties;
+		// Node struct has extra SaveGame properties or scriptable element instance has SaveGame properties
+		TBitArray<> ExtraStateNodes;
+	};
+	FSaveStateLayout SaveStateLayout;
+	void BuildSaveStateLayout(const UGameQuestGraphBase& Quest);
+
 	TMap<uint16, TArray<uint16, TInlineAllocator<1>>> NodeToSuccessorMap;
 	TMap<uint16, TArray<uint16, TInlineAllocator<1>>> NodeToPredecessorMap;
 	struct FEventNameNodeId
@@ -57,4 +141,29 @@ public:
 	TMap<uint16, TArray<FEventNameNodeId, TInlineAllocator<1>>> NodeIdEventNameMap;
 	TMap<FName, FStructProperty*> RerouteTags;
 	TMap<FName, TArray<FEventNameNodeId, TInlineAllocator<1>>> RerouteTagPreNodesMap;
+
+	// Successor graph for force activate cheat, built at the first use under lock because all pairs tables cost too much to build for every class
+	struct FSuccessorGraph
+	{
+		int32 NodeNum = 0;
+		// CSR adjacency of NodeToSuccessorMap
+		TArray<int32> Offsets;
+		TArray<uint16> Successors;
+		// Row is from node, column is to node, shortest path by breadth first search
+		TArray<uint16> NextHops;
+		TArray<uint16> Distances;
+		// (event node id << 16 | next node id) -> event name
+		TMap<uint32, FName> EdgeEventNames;
+
+		static constexpr uint16 Unreachable = MAX_uint16;
+		uint16 GetDistance(uint16 From, uint16 To) const { return From < NodeNum && To < NodeNum ? Distances[From * NodeNum + To] : Unreachable; }
+		uint16 GetNextHop(uint16 From, uint16 To) const { return NextHops[From * NodeNum + To]; }
+		FName GetEventName(uint16 EventNodeId, uint16 NextNodeId) const { return EdgeEventNames.FindRef(uint32(EventNodeId) << 16 | NextNodeId); }
+	};
+	const FSuccessorGraph& GetSuccessorGraph() const;
+private:
+	mutable TUniquePtr<const FSuccessorGraph> SuccessorGraph;
+	mutable FCriticalSection SuccessorGraphLock;
+	std::atomic<bool> bRuntimeTablesBuilt{ false };
+	FCriticalSection RuntimeTablesLock;
 };
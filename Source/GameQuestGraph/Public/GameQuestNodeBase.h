@@ -7,6 +7,33 @@
 #include "GameQuestNodeBase.generated.h"
 
 class UGameQuestGraphBase;
+struct FGameQuestNodeBase;
+
+// Per class node init data, built once from the class default object so instance init is a flat walk
+struct GAMEQUESTGRAPH_API FGameQuestNodeInitDesc
+{
+	FGameQuestNodeInitDesc(const UClass* QuestClass, FStructProperty* InProperty, const FGameQuestNodeBase& TemplateNode);
+
+	FStructProperty* Property = nullptr;
+	int32 Offset = INDEX_NONE;
+	uint16 NodeId = GameQuest::IdNone;
+	const GameQuest::FLogicList* LogicList = nullptr;
+	UFunction* EvaluateParamsFunction = nullptr;
+
+	struct FEventBinding
+	{
+		// Offset of TObjectPtr<UFunction> from the owner (node or instance)
+		int32 Offset;
+		UFunction* Event;
+	};
+	TArray<FEventBinding, TInlineAllocator<2>> EventBindings;
+	static FEventBinding MakeEventBinding(const void* Owner, const TObjectPtr<UFunction>& Slot, UFunction* Event);
+	static void ApplyEventBindings(void* Owner, TConstArrayView<FEventBinding> Bindings);
+
+	// Bindings of instanced subobject, resolved from the instance of template node
+	const UClass* InstanceClass = nullptr;
+	TArray<FEventBinding, TInlineAllocator<2>> InstanceEventBindings;
+};
 
 // meta = (GenerateSingleEvaluateFunction) will generate single evaluate property function, can use MakeEvaluateSingleParamFunctionName get function name
 USTRUCT(BlueprintType, BlueprintInternalUseOnly, meta = (Hidden))
@@ -15,11 +42,15 @@ struct GAMEQUESTGRAPH_API FGameQuestNodeBase
 	GENERATED_BODY()
 
 	friend class UGameQuestGraphBase;
+	friend FGameQuestNodeInitDesc;
+	friend class UGameQuestTickManager;
+	friend struct FGameQuestStateSerializer;
 public:
 	virtual ~FGameQuestNodeBase() = default;
 
 	virtual UScriptStruct* GetNodeStruct() const { return NodeProperty->Struct; }
 	virtual FName GetNodeName() const { return NodeProperty->GetFName(); }
+	uint16 GetNodeId() const { return NodeId; }
 
 	TObjectPtr<UGameQuestGraphBase> OwnerQuest = nullptr;
 	TObjectPtr<UFunction> EvaluateParamsFunction = nullptr;
@@ -31,9 +62,20 @@ public:
 
 	void MarkNodeNetDirty() const;
 protected:
+	virtual void BuildQuestInitDesc(FGameQuestNodeInitDesc& Desc, const UClass* QuestClass) const {}
+	// Default forward to the deprecated overload, so node only overriding the old one is still initialized
+	virtual void WhenQuestInitProperties(const FGameQuestNodeInitDesc& Desc)
+	{
+PRAGMA_DISABLE_DEPRECATION_WARNINGS
+		WhenQuestInitProperties(Desc.Property);
+PRAGMA_ENABLE_DEPRECATION_WARNINGS
+	}
+	UE_DEPRECATED(5.2, "Override WhenQuestInitProperties(const FGameQuestNodeInitDesc&) instead, per class data such as finish event binding should be resolved in BuildQuestInitDesc.")
 	virtual void WhenQuestInitProperties(const FStructProperty* Property) {}
 	virtual bool ShouldReplicatedSubobject() const { return false; }
 	virtual bool ReplicateSubobject(class UActorChannel* Channel, class FOutBunch* Bunch, struct FReplicationFlags* RepFlags) { return false; }
+	// Subobject registered to component registered subobject list
+	virtual UObject* GetReplicatedSubobject() const { return nullptr; }
 	virtual void WhenOnRepValue(const FGameQuestNodeBase& PreValue) {}
 
 #if WITH_EDITOR
@@ -41,6 +83,10 @@ protected:
 #endif
 private:
 	FStructProperty* NodeProperty;
+	uint16 NodeId = GameQuest::IdNone;
+	const GameQuest::FLogicList* LogicList = nullptr;
+	int32 TickBucket = INDEX_NONE;
+	int32 TickIndex = INDEX_NONE;
 };
 
 template<typename T>
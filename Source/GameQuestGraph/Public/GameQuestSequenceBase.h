@@ -9,15 +9,6 @@
 struct FGameQuestElementBase;
 struct FGameQuestSequenceBase;
 
-namespace Context
-{
-	extern uint16 CurrentFinishedSequenceId;
-	extern uint16 CurrentFinishedBranchId;
-
-	using FAddNextSequenceIdFunc = TFunction<void(uint16)>;
-	extern FAddNextSequenceIdFunc AddNextSequenceIdFunc;
-}
-
 USTRUCT(meta = (Hidden))
 struct GAMEQUESTGRAPH_API FGameQuestSequenceBase : public FGameQuestNodeBase
 {
@@ -46,7 +37,10 @@ private:
 	template<bool bHasAuthority>
 	void DeactivateSequenceImpl(uint16 SequenceId);
 
+	friend class UGameQuestTickManager;
 	void Tick(float DeltaSeconds) { WhenTick(DeltaSeconds); }
+	void RegisterTick();
+	void UnregisterTick();
 public:
 	UPROPERTY(SaveGame)
 	uint16 PreSequence{ GameQuest::IdNone };
@@ -62,8 +56,14 @@ public:
 		Finished,
 		Interrupted,
 	};
-	EState GetSequenceState() const;
-
+	EState GetSequenceState() const { return State; }
+	void WhenOnRepValue(const FGameQuestNodeBase& PreValue) override;
+protected:
+	// Kept at transition, evaluated again when loaded or replicated
+	EState State = EState::Deactivated;
+	EState EvaluateSequenceState() const;
+	void RefreshSequenceState() { State = EvaluateSequenceState(); }
+public:
 	virtual TArray<uint16> GetNextSequences() const { unimplemented(); return {}; }
 	virtual TArray<uint16> GetElementIds() const { unimplemented(); return {}; }
 protected:
@@ -77,7 +77,7 @@ protected:
 	virtual void WhenElementUnfinished(FGameQuestElementBase* FinishedElement) { unimplemented(); }
 
 	void ExecuteFinishEvent(UFunction* FinishEvent, const TArray<uint16>& NextSequenceIds, uint16 BranchId) const;
-	bool CanFinishListElements(const TArray<uint16>& Elements, const GameQuest::FLogicList& ElementLogics) const;
+	bool CanFinishListElements(const FGameQuestNodeBase& ListNode, const TArray<uint16>& Elements) const;
 };
 
 USTRUCT(meta = (DisplayName = "Sequence Single"))
@@ -107,7 +107,7 @@ struct GAMEQUESTGRAPH_API FGameQuestSequenceList : public FGameQuestSequenceBase
 {
 	GENERATED_BODY()
 public:
-	void WhenQuestInitProperties(const FStructProperty* Property) override;
+	void BuildQuestInitDesc(FGameQuestNodeInitDesc& Desc, const UClass* QuestClass) const override;
 
 	UPROPERTY(NotReplicated)
 	TArray<uint16> Elements;
@@ -175,6 +175,10 @@ public:
 	void WhenElementFinished(FGameQuestElementBase* FinishedElement, const FGameQuestFinishEvent& OnElementFinishedEvent) override;
 	void WhenElementUnfinished(FGameQuestElementBase* FinishedElement) override;
 
+	GameQuest::FBranchElementRole GetElementRole(uint16 ElementId) const;
+	FGameQuestSequenceBranchElement* FindBranch(uint16 BranchElementId);
+	const FGameQuestSequenceBranchElement* FindBranch(uint16 BranchElementId) const { return const_cast<FGameQuestSequenceBranch*>(this)->FindBranch(BranchElementId); }
+
 	bool CanActivateBranchElement() const;
 	void ActivateBranches(bool bHasAuthority);
 	void DeactivateBranches(bool bHasAuthority);
@@ -206,6 +210,7 @@ struct GAMEQUESTGRAPH_API FGameQuestSequenceSubQuest : public FGameQuestSequence
 public:
 	bool ShouldReplicatedSubobject() const override { return true; }
 	bool ReplicateSubobject(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
+	UObject* GetReplicatedSubobject() const override { return SubQuestInstance; }
 
 	UPROPERTY(NotReplicated)
 	TSoftClassPtr<UGameQuestGraphBase> SubQuestClass;
@@ -222,8 +227,6 @@ public:
 	void WhenSequenceActivated(bool bHasAuthority) override;
 	void WhenSequenceDeactivated(bool bHasAuthority) override;
 	void WhenOnRepValue(const FGameQuestNodeBase& PreValue) override;
-	bool IsTickable() const override { return true; }
-	void WhenTick(float DeltaSeconds) override;
 	TArray<uint16> GetNextSequences() const override;
 	TArray<uint16> GetElementIds() const override { return {}; }
 
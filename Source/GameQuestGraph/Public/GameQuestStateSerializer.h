@@ -0,0 +1,48 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UGameQuestComponent;
+class UGameQuestGraphBase;
+
+// Versioned binary save of quest runtime state, restore into node state directly without property tag parsing
+// Flags are saved as bitset indexed by node id and links as varint node id, so save is still valid after quest graph changed
+// Node with state beyond flags is saved as one size framed record, record of removed or changed type node is skipped
+// Component can be saved as delta, only quests and node records changed after a save generation are written, CompactSave merge deltas into base
+struct GAMEQUESTGRAPH_API FGameQuestStateSerializer
+{
+	enum class EVersion : uint32
+	{
+		Initial = 1,
+		// Quest saved with name, component save has generation, state header is framed
+		DeltaSave,
+
+		LatestPlusOne,
+		Latest = LatestPlusOne - 1
+	};
+
+	static void SaveQuest(const UGameQuestGraphBase& Quest, TArray<uint8>& OutData);
+	// Quest is created in component then added by AddQuest, activated quest is reactived by it
+	static UGameQuestGraphBase* LoadQuest(UGameQuestComponent& Component, const TArray<uint8>& Data, bool bAutoActivate = true);
+
+	// Activated, finished and archived quests of component, return the save generation used as base of later delta save
+	static uint32 SaveComponent(UGameQuestComponent& Component, TArray<uint8>& OutData);
+	// Only load full save, deltas should be merged by CompactSave first
+	static bool LoadComponent(UGameQuestComponent& Component, const TArray<uint8>& Data);
+	// Changed quests, removed quests and new archived records after SinceGeneration, return 0 when SinceGeneration is older than the last full save
+	static uint32 SaveComponentDelta(UGameQuestComponent& Component, uint32 SinceGeneration, TArray<uint8>& OutData);
+	// Merge deltas into full component save in order, no quest object is created
+	static bool CompactSave(const TArray<uint8>& BaseData, TConstArrayView<TArray<uint8>> DeltaDatas, TArray<uint8>& OutData);
+
+	// SaveGame properties not saved by state layout, saved by name with their own serializer
+	static void GetExtraSaveProperties(const UStruct* Struct, TArray<const FProperty*>& OutProperties);
+private:
+	static bool ReadVersion(FArchive& Ar, EVersion& OutVersion);
+	static void WriteQuest(FArchive& Ar, const UGameQuestGraphBase& Quest, uint32 SinceGeneration = 0);
+	// OutRenamedFrom is set to the saved name when it is already used in outer
+	static UGameQuestGraphBase* ReadQuest(FArchive& Ar, UObject* Outer, EVersion Version, FName* OutRenamedFrom = nullptr);
+	static void WriteQuestState(FArchive& Ar, const UGameQuestGraphBase& Quest, uint32 SinceGeneration);
+	static bool ReadQuestState(FArchive& Ar, UGameQuestGraphBase& Quest, EVersion Version);
+};
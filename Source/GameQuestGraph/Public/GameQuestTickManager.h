@@ -0,0 +1,123 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameQuestType.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "GameQuestTickManager.generated.h"
+
+class UGameQuestComponent;
+class UGameQuestGraphBase;
+struct FGameQuestNodeBase;
+struct FGameQuestElementBase;
+struct FGameQuestSequenceBase;
+
+// Tick all tickable quest nodes of world, quest component don't tick itself
+// Elements are bucketed by tick interval and staggered across frames by phase
+UCLASS()
+class GAMEQUESTGRAPH_API UGameQuestTickManager : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	static UGameQuestTickManager* Get(const UObject* WorldContextObject);
+
+	void Initialize(FSubsystemCollectionBase& Collection) override;
+	void Deinitialize() override;
+	void Tick(float DeltaTime) override;
+	TStatId GetStatId() const override;
+
+	void RegisterElement(FGameQuestElementBase& Element);
+	void UnregisterElement(FGameQuestElementBase& Element);
+	void RegisterSequence(FGameQuestSequenceBase& Sequence);
+	void UnregisterSequence(FGameQuestSequenceBase& Sequence);
+	void UnregisterComponent(const UGameQuestComponent* Component);
+
+	struct FTickStats
+	{
+		int32 TickedNum = 0;
+		// Due but not ticked because of tick budget
+		int32 DeferredNum = 0;
+	};
+	const FTickStats& GetLastFrameStats() const { return LastFrameStats; }
+	uint64 GetTotalDeferredNum() const { return TotalDeferredNum; }
+
+	// Optional significance source (e.g. significance manager), evaluated for each quest component periodically
+	DECLARE_DELEGATE_RetVal_OneParam(float, FEvaluateSignificance, const UGameQuestComponent* /*Component*/);
+	FEvaluateSignificance EvaluateSignificance;
+
+	// Return manager when GameQuest.DeferredEvents enabled, element finish and interrupt outside quest process are queued and processed before node tick
+	static UGameQuestTickManager* GetDeferredEventQueue(const UObject* WorldContextObject);
+	void EnqueueFinishElement(FGameQuestElementBase& Element, const FGameQuestFinishEvent& FinishEvent);
+	void EnqueueUnfinishElement(FGameQuestElementBase& Element);
+	void EnqueueInterruptSequence(FGameQuestSequenceBase& Sequence);
+	void EnqueueInterruptBranch(FGameQuestElementBase& Element);
+	void EnqueueInterruptQuest(UGameQuestGraphBase& Quest);
+	void ProcessDeferredEvents();
+
+	// Component element requests are flushed at the end of tick
+	void AddPendingElementRequests(UGameQuestComponent& Component);
+protected:
+	bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+private:
+	struct FTickEntry
+	{
+		TWeakObjectPtr<UGameQuestGraphBase> Quest;
+		TWeakObjectPtr<UGameQuestComponent> Component;
+		FGameQuestNodeBase* Node;
+		double LastTickTime;
+		double NextTickTime;
+		bool bIgnoreSignificance;
+	};
+	struct FTickBucket
+	{
+		float Interval = 0.f;
+		uint32 StaggerCounter = 0;
+		// Round robin start of next frame
+		int32 Cursor = 0;
+		TArray<FTickEntry> Entries;
+	};
+	// Bucket never removed, node keep the bucket index
+	TArray<FTickBucket> Buckets;
+	static constexpr int32 SequenceBucket = 0;
+	double TickTime = 0.0;
+	bool bIsTicking = false;
+	bool bHasPendingRemove = false;
+	FTickStats LastFrameStats;
+	uint64 TotalDeferredNum = 0;
+
+	enum class EDeferredEvent : uint8
+	{
+		// Canceled by the opposite event, skipped when dispatch
+		None,
+		Finish,
+		Unfinish,
+		InterruptSequence,
+		InterruptBranch,
+		InterruptQuest,
+	};
+	struct FDeferredEvent
+	{
+		TWeakObjectPtr<UGameQuestGraphBase> Quest;
+		uint16 NodeId;
+		EDeferredEvent Type;
+		FGameQuestFinishEvent FinishEvent;
+	};
+	TArray<FDeferredEvent> DeferredEvents;
+	// (quest, node id) -> index of the last pending event in DeferredEvents
+	TMap<TPair<TObjectKey<UGameQuestGraphBase>, uint16>, int32> PendingEventIndices;
+	// Event processed inside dispatch run at once, same as not deferred
+	bool bIsDispatchingEvent = false;
+	void EnqueueEvent(UGameQuestGraphBase& Quest, uint16 NodeId, EDeferredEvent Type, const FGameQuestFinishEvent& FinishEvent = {});
+	void DispatchEvent(const FDeferredEvent& Event);
+
+	TArray<TWeakObjectPtr<UGameQuestComponent>> PendingRequestComponents;
+
+	int32 FindOrAddBucket(float Interval);
+	void RegisterEntry(int32 BucketIndex, FGameQuestNodeBase& Node, float Phase, bool bIgnoreSignificance);
+	float GetSignificance(FTickEntry& Entry);
+	void UnregisterEntry(FGameQuestNodeBase& Node);
+	void RemoveEntryAt(TArray<FTickEntry>& Entries, int32 Index);
+	static void CompactEntries(TArray<FTickEntry>& Entries);
+};
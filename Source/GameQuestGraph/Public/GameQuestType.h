@@ -21,8 +21,63 @@ namespace GameQuest
 {
 	constexpr uint16 IdNone = 0;
 	using FLogicList = TArray<EGameQuestSequenceLogic, TInlineAllocator<4>>;
+
+	enum class EBranchElementRole : uint8
+	{
+		None,
+		Precondition,
+		Branch,
+		BranchListMember,
+	};
+	// Role of element in its sequence branch, branch list member keep the branch own the list
+	struct FBranchElementRole
+	{
+		EBranchElementRole Role = EBranchElementRole::None;
+		int16 BranchIndex = INDEX_NONE;
+	};
 }
 
+struct FGameQuestNodeBase;
+
+// Where activated next sequence id recorded to, the next sequences of a finished node or start sequences of quest
+struct GAMEQUESTGRAPH_API FGameQuestSuccessorSink
+{
+	FGameQuestSuccessorSink() = default;
+	FGameQuestSuccessorSink(TArray<uint16>& InNextSequences, const FGameQuestNodeBase& InNode)
+		: NextSequences(&InNextSequences), Node(&InNode)
+	{}
+	FGameQuestSuccessorSink(TArray<uint16>& InStartSequences, UGameQuestGraphBase& InQuest)
+		: NextSequences(&InStartSequences), Quest(&InQuest)
+	{}
+
+	void Add(uint16 SequenceId) const;
+private:
+	TArray<uint16>* NextSequences = nullptr;
+	// Mark dirty who own the next sequences
+	const FGameQuestNodeBase* Node = nullptr;
+	UGameQuestGraphBase* Quest = nullptr;
+};
+
+// State of quest transition in process, owned by root quest so each quest tree could be processed independently
+struct FGameQuestExecutionContext
+{
+	// For finish quest element context
+	uint16 CurrentFinishedSequenceId = GameQuest::IdNone;
+	uint16 CurrentFinishedBranchId = GameQuest::IdNone;
+	FName PreRerouteTagName;
+
+	FGameQuestSuccessorSink SuccessorSink;
+	TArray<FGameQuestSuccessorSink, TInlineAllocator<2>> StartCachedSuccessorSinks;
+
+	struct FLastFinished
+	{
+		UGameQuestGraphBase* Quest = nullptr;
+		uint16 SequenceId = GameQuest::IdNone;
+		uint16 BranchId = GameQuest::IdNone;
+	};
+	TArray<FLastFinished, TInlineAllocator<2>> LastFinishedStack;
+};
+
 USTRUCT(BlueprintType)
 struct GAMEQUESTGRAPH_API FGameQuestFinishEvent
 {